@@ -0,0 +1,110 @@
+// Host microbenchmark: WLEDPayload against the JsonDocument + String path
+// that built every /json/state body before it.
+//
+//   pio run -e native_bench && .pio/build/native_bench/program [iterations]
+//
+// Both builders produce the same color update; the report gives the time
+// and heap allocations per body for each.
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "../../src/WLEDPayload.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<unsigned long> allocations(0);
+
+// The pre-WLEDPayload WLEDController::updateColor() body
+String buildWithJsonDocument(int red, int green, int blue) {
+    JsonDocument doc;
+    doc["on"] = true;
+    doc["bri"] = 255;
+    JsonArray seg = doc["seg"].to<JsonArray>();
+    JsonObject segment = seg.add<JsonObject>();
+    JsonArray col = segment["col"].to<JsonArray>();
+    JsonArray color = col.add<JsonArray>();
+    color.add(red);
+    color.add(green);
+    color.add(blue);
+
+    String jsonString;
+    serializeJson(doc, jsonString);
+    return jsonString;
+}
+
+void buildWithPayload(WLEDPayload& payload, int red, int green, int blue) {
+    payload.beginState();
+    payload.addBrightness(255);
+    payload.addColor(red, green, blue);
+    payload.end();
+}
+
+struct Result {
+    double nsPerBody;
+    double allocationsPerBody;
+    size_t bytes;   // Of the last body
+};
+
+template <typename Build>
+Result measure(unsigned long iterations, Build build) {
+    const unsigned long allocationsBefore = allocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    size_t bytes = 0;
+    for (unsigned long i = 0; i < iterations; i++) {
+        bytes = build(i & 0xFF, (i >> 3) & 0xFF, (i >> 6) & 0xFF);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+    return Result{ns / iterations,
+                  static_cast<double>(allocations.load() - allocationsBefore) / iterations, bytes};
+}
+
+}  // namespace
+
+// Counts every heap allocation in the process
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* block = malloc(size);
+    if (block == nullptr) throw std::bad_alloc();
+    return block;
+}
+void operator delete(void* block) noexcept { free(block); }
+void operator delete(void* block, size_t) noexcept { free(block); }
+
+int main(int argc, char** argv) {
+    const unsigned long iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+
+    // Same color in both bodies, or the comparison means nothing
+    WLEDPayload payload;
+    buildWithPayload(payload, 12, 34, 56);
+    const String reference = buildWithJsonDocument(12, 34, 56);
+    const bool same = strstr(payload.c_str(), "\"col\":[[12,34,56]]") != nullptr &&
+                      strstr(reference.c_str(), "\"col\":[[12,34,56]]") != nullptr;
+    printf("WLEDPayload:  %s\n", payload.c_str());
+    printf("JsonDocument: %s\n", reference.c_str());
+    if (!same) {
+        printf("Bodies carry different colors\n");
+        return 1;
+    }
+
+    const Result json = measure(iterations, [](int red, int green, int blue) {
+        return buildWithJsonDocument(red, green, blue).length();
+    });
+    const Result fixed = measure(iterations, [&payload](int red, int green, int blue) {
+        buildWithPayload(payload, red, green, blue);
+        return payload.length();
+    });
+
+    printf("\n%lu color bodies each\n", iterations);
+    printf("  JsonDocument + String: %8.1f ns, %5.1f allocations, %zu bytes\n",
+           json.nsPerBody, json.allocationsPerBody, json.bytes);
+    printf("  WLEDPayload:           %8.1f ns, %5.1f allocations, %zu bytes\n",
+           fixed.nsPerBody, fixed.allocationsPerBody, fixed.bytes);
+    printf("  Speedup:               %8.1fx\n", json.nsPerBody / fixed.nsPerBody);
+    return fixed.allocationsPerBody == 0 ? 0 : 1;
+}
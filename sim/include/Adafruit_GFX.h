@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Minimal Adafruit_GFX: pixel, rectangle and text primitives. Glyphs are
+// 5x7 placeholders derived from the character code - not legible, but
+// different characters light different pixels, which is what matters for
+// dirty-region and I2C byte measurements.
+class Adafruit_GFX : public Print {
+public:
+    Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+
+    void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+    void setTextSize(uint8_t size) { textSize = size > 0 ? size : 1; }
+    void setTextColor(uint16_t color) { textColor = color; textBackground = color; }
+    void setTextColor(uint16_t color, uint16_t background) { textColor = color; textBackground = background; }
+    void setTextWrap(bool wrap) { textWrap = wrap; }
+    int16_t getCursorX() const { return cursorX; }
+    int16_t getCursorY() const { return cursorY; }
+    void getTextBounds(const char* text, int16_t x, int16_t y,
+                       int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h);
+
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+
+protected:
+    int16_t _width;
+    int16_t _height;
+    int16_t cursorX = 0;
+    int16_t cursorY = 0;
+    uint8_t textSize = 1;
+    uint16_t textColor = 1;
+    uint16_t textBackground = 1;
+    bool textWrap = true;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <Adafruit_GFX.h>
+#include <Wire.h>
+
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+#define SSD1306_SWITCHCAPVCC 0x02
+#define SSD1306_MEMORYMODE 0x20
+#define SSD1306_COLUMNADDR 0x21
+#define SSD1306_PAGEADDR 0x22
+#define SSD1306_DISPLAYOFF 0xAE
+#define SSD1306_DISPLAYON 0xAF
+
+// Same buffer layout and I2C traffic shape as the real driver
+class Adafruit_SSD1306 : public Adafruit_GFX {
+public:
+    Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi, int8_t resetPin);
+    ~Adafruit_SSD1306();
+
+    bool begin(uint8_t vcs, uint8_t address);
+    void display();
+    void clearDisplay();
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    uint8_t* getBuffer() { return buffer; }
+    void ssd1306_command(uint8_t c);
+    void dim(bool dim) { (void)dim; }
+
+private:
+    TwoWire* wire;
+    uint8_t* buffer;
+    uint8_t i2cAddress;
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+// Host stand-in for the ESP32 Arduino core, just wide enough for this
+// firmware. Time is real (steady_clock), GPIO is simulated, see Sim.h.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define PROGMEM
+#define F(text) (text)
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define DEC 10
+#define HEX 16
+
+typedef uint8_t byte;
+using std::min;
+using std::max;
+
+template <typename T, typename L, typename H>
+auto constrain(T value, L low, H high) -> decltype(value + low) {
+    return value < low ? low : (value > high ? high : value);
+}
+
+class String : public std::string {
+public:
+    String() {}
+    String(const char* text) : std::string(text ? text : "") {}
+    String(const std::string& text) : std::string(text) {}
+    String(char c) : std::string(1, c) {}
+    String(int value) : std::string(std::to_string(value)) {}
+    String(unsigned int value) : std::string(std::to_string(value)) {}
+    String(long value) : std::string(std::to_string(value)) {}
+    String(unsigned long value) : std::string(std::to_string(value)) {}
+    String(double value, unsigned int decimals = 2);
+
+    const char* c_str() const { return std::string::c_str(); }
+    unsigned int length() const { return static_cast<unsigned int>(size()); }
+    bool isEmpty() const { return empty(); }
+    long toInt() const { return strtol(c_str(), nullptr, 10); }
+    int indexOf(const char* text) const {
+        size_t pos = find(text);
+        return pos == npos ? -1 : static_cast<int>(pos);
+    }
+    String substring(unsigned int from, unsigned int to = ~0u) const {
+        return String(std::string::substr(from, to == ~0u ? npos : to - from));
+    }
+    bool concat(const char* text) { append(text); return true; }
+    bool concat(char c) { push_back(c); return true; }
+};
+
+// Present so ArduinoJson's Arduino String adapters compile
+class StringSumHelper : public String {
+public:
+    using String::String;
+};
+
+inline String operator+(const String& a, const String& b) { return String(std::string(a) + std::string(b)); }
+inline String operator+(const String& a, const char* b) { return String(std::string(a) + b); }
+inline String operator+(const char* a, const String& b) { return String(a + std::string(b)); }
+
+class Print;
+
+class Printable {
+public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print& out) const = 0;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t written = 0;
+        while (size--) written += write(*buffer++);
+        return written;
+    }
+    size_t write(const char* text) { return write(reinterpret_cast<const uint8_t*>(text), strlen(text)); }
+
+    size_t print(const char* text) { return write(text); }
+    size_t print(const String& text) { return write(text.c_str()); }
+    size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+    size_t print(int value, int base = DEC) { return print(static_cast<long>(value), base); }
+    size_t print(unsigned int value, int base = DEC) { return print(static_cast<unsigned long>(value), base); }
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+    size_t print(const Printable& value) { return value.printTo(*this); }
+
+    template <typename T>
+    size_t println(const T& value) { return print(value) + println(); }
+    size_t println() { return write("\r\n"); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+    virtual int peek() { return -1; }
+    void setTimeout(unsigned long timeoutMs) { timeout = timeoutMs; }
+
+protected:
+    unsigned long timeout = 1000;
+};
+
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+uint32_t esp_random();
+
+// Timing
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+// GPIO and interrupts, backed by the simulated pin bank in Sim.h
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+inline int digitalPinToInterrupt(int pin) { return pin; }
+void attachInterrupt(int pin, void (*handler)(), int mode);
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode);
+void detachInterrupt(int pin);
+void noInterrupts();
+void interrupts();
+
+class EspClass {
+public:
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getFreeHeap() { return 200 * 1024; }
+    void restart();
+};
+
+extern EspClass ESP;
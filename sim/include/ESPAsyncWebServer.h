@@ -0,0 +1,131 @@
+#pragma once
+
+#include <WiFi.h>
+#include <functional>
+#include <map>
+#include <vector>
+
+// Route table only: nothing listens on a socket. Scenarios call
+// sim::webRequest() to run a handler and inspect the response.
+
+typedef enum {
+    HTTP_GET = 0b00000001,
+    HTTP_POST = 0b00000010,
+    HTTP_ANY = 0b01111111
+} WebRequestMethod;
+
+class AsyncClient {
+public:
+    IPAddress remoteIP() const { return IPAddress(127, 0, 0, 1); }
+};
+
+class AsyncWebHeader {
+public:
+    AsyncWebHeader(const String& name, const String& value) : headerName(name), headerValue(value) {}
+    const String& name() const { return headerName; }
+    const String& value() const { return headerValue; }
+
+private:
+    String headerName;
+    String headerValue;
+};
+
+class AsyncWebServerResponse {
+public:
+    AsyncWebServerResponse(int code, const String& contentType, const String& content)
+        : code(code), contentType(contentType), content(content) {}
+    void addHeader(const String& name, const String& value) { headers[name] = value; }
+    void setCode(int newCode) { code = newCode; }
+
+    int code;
+    String contentType;
+    String content;
+    std::map<std::string, String> headers;
+};
+
+class AsyncWebServerRequest {
+public:
+    explicit AsyncWebServerRequest(const String& path) : requestPath(path) {}
+    ~AsyncWebServerRequest() {
+        delete response;
+        for (AsyncWebHeader* header : requestHeaders) delete header;
+    }
+
+    AsyncClient* client() { return &clientInfo; }
+    const String& url() const { return requestPath; }
+
+    bool hasHeader(const char* name) const;
+    AsyncWebHeader* getHeader(const char* name) const;
+    void addRequestHeader(const String& name, const String& value);
+
+    AsyncWebServerResponse* beginResponse(int code, const String& contentType = String(),
+                                          const String& content = String());
+    AsyncWebServerResponse* beginResponse_P(int code, const String& contentType,
+                                            const uint8_t* content, size_t length);
+    void send(AsyncWebServerResponse* response);
+    void send(int code, const String& contentType = String(), const String& content = String());
+
+    AsyncWebServerResponse* response = nullptr;
+
+private:
+    String requestPath;
+    AsyncClient clientInfo;
+    std::vector<AsyncWebHeader*> requestHeaders;
+};
+
+typedef std::function<void(AsyncWebServerRequest*)> ArRequestHandlerFunction;
+
+class AsyncWebHandler {
+public:
+    virtual ~AsyncWebHandler() {}
+};
+
+// Server-Sent Events. Clients are opened by sim::openEventStream() and
+// record every message they are sent.
+class AsyncEventSourceClient {
+public:
+    void send(const char* message, const char* event = nullptr, uint32_t id = 0, uint32_t reconnect = 0);
+    void close() { open = false; }
+    bool connected() const { return open; }
+    uint32_t lastId() const { return lastEventId; }
+
+    std::vector<std::string> received;  // "event: data" per message
+
+private:
+    bool open = true;
+    uint32_t lastEventId = 0;
+};
+
+typedef std::function<void(AsyncEventSourceClient*)> ArEventHandlerFunction;
+
+class AsyncEventSource : public AsyncWebHandler {
+public:
+    explicit AsyncEventSource(const String& url);
+    ~AsyncEventSource();
+    void onConnect(ArEventHandlerFunction handler) { connectHandler = handler; }
+    void send(const char* message, const char* event = nullptr, uint32_t id = 0, uint32_t reconnect = 0);
+    size_t count() const;
+    void close();
+
+    const String& url() const { return path; }
+    AsyncEventSourceClient* connect();  // Simulator side
+
+private:
+    String path;
+    ArEventHandlerFunction connectHandler;
+    std::vector<AsyncEventSourceClient*> clients;
+};
+
+class AsyncWebServer {
+public:
+    explicit AsyncWebServer(uint16_t port) : port(port) {}
+    void on(const char* uri, WebRequestMethod method, ArRequestHandlerFunction handler);
+    void addHandler(AsyncWebHandler* handler) { handlers.push_back(handler); }
+    void onNotFound(ArRequestHandlerFunction handler) { notFound = handler; }
+    void begin() {}
+
+private:
+    uint16_t port;
+    ArRequestHandlerFunction notFound;
+    std::vector<AsyncWebHandler*> handlers;
+};
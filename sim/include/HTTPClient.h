@@ -0,0 +1,66 @@
+#pragma once
+
+#include <WiFi.h>
+
+#define HTTPC_ERROR_CONNECTION_REFUSED  (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED  (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED       (-4)
+#define HTTPC_ERROR_CONNECTION_LOST     (-5)
+#define HTTPC_ERROR_NO_STREAM           (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER      (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM        (-8)
+#define HTTPC_ERROR_ENCODING            (-9)
+#define HTTPC_ERROR_STREAM_WRITE        (-10)
+#define HTTPC_ERROR_READ_TIMEOUT        (-11)
+
+#define HTTP_CODE_OK 200
+#define HTTP_CODE_NOT_MODIFIED 304
+
+// HTTP/1.1 client with the ESP32 HTTPClient's keep-alive behaviour: with
+// setReuse(true) the socket stays open between requests and is reopened
+// transparently when the server has closed it.
+class HTTPClient {
+public:
+    ~HTTPClient() { end(); }
+
+    bool begin(String url);
+    bool begin(WiFiClient& client, String url);
+    bool begin(WiFiClient& client, String host, uint16_t port, String uri = "/", bool https = false);
+    void end();
+
+    void setReuse(bool reuse) { this->reuse = reuse; }
+    void setTimeout(uint16_t timeoutMs) { timeout = timeoutMs; }
+    void setConnectTimeout(int32_t timeoutMs) { connectTimeout = timeoutMs; }
+    void useHTTP10(bool http10 = true) { useHttp10 = http10; }
+    void addHeader(const String& name, const String& value);
+
+    int GET();
+    int POST(uint8_t* payload, size_t size);
+    int POST(const String& payload) { return POST((uint8_t*)payload.c_str(), payload.length()); }
+    int sendRequest(const char* method, const uint8_t* payload, size_t size);
+
+    bool connected();
+    int getSize() const { return size; }
+    WiFiClient& getStream() { return *client; }
+    WiFiClient* getStreamPtr() { return connected() ? client : nullptr; }
+    String getString();
+    static String errorToString(int error);
+
+private:
+    WiFiClient* client = nullptr;
+    WiFiClient ownClient;
+    String host;
+    uint16_t port = 80;
+    String uri = "/";
+    String headers;
+    bool reuse = true;
+    bool canReuse = false;
+    bool useHttp10 = false;
+    uint16_t timeout = 5000;
+    int32_t connectTimeout = 5000;
+    int size = -1;
+
+    int readResponseHeaders();
+    bool readLine(String& line);
+};
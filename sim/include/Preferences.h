@@ -0,0 +1,33 @@
+#pragma once
+
+#include <Arduino.h>
+#include <string>
+
+// ESP32 Preferences (NVS) over the simulator's key-value store, which is
+// kept in memory or, with SIM_NVS=<file>, in a file that survives runs.
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+    void end() { opened = false; }
+
+    size_t putBytes(const char* key, const void* value, size_t length);
+    size_t getBytes(const char* key, void* buffer, size_t maxLength);
+    size_t getBytesLength(const char* key);
+    size_t putUInt(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) {
+        uint32_t value;
+        return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+    }
+    size_t putString(const char* key, const String& value) { return putBytes(key, value.c_str(), value.length() + 1); }
+    String getString(const char* key, const String& defaultValue = String());
+    bool isKey(const char* key) { return getBytesLength(key) > 0; }
+    bool remove(const char* key);
+    bool clear();
+
+private:
+    std::string space;
+    bool opened = false;
+    bool readOnly = false;
+
+    std::string fullKey(const char* key) const { return space + "/" + key; }
+};
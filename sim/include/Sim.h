@@ -0,0 +1,101 @@
+#pragma once
+
+// Control surface of the host simulator: drives GPIO waveforms into the
+// firmware's ISRs and exposes what the firmware wrote to the OLED and to
+// the WLED stand-in.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+constexpr int PIN_COUNT = 48;
+
+// GPIO: set a pin level as the outside world drives it. Matching
+// attachInterrupt() handlers run synchronously on the calling thread, with
+// interrupts "disabled" the way they would be in a real ISR.
+void setPin(uint8_t pin, int level);
+int getPin(uint8_t pin);
+void sleepUs(unsigned long us);
+
+// Scripted inputs
+// One detent is a full quadrature cycle (four edges), stepUs apart.
+// Negative detents turn the other way.
+void turnEncoder(uint8_t pinA, uint8_t pinB, int detents, unsigned long edgeIntervalUs);
+// Press and release with bounces edges on each transition, bounceUs apart
+void pressButton(uint8_t pin, unsigned long holdMs, int bounces, unsigned long bounceUs);
+
+// SSD1306 model fed by every Wire transaction to the display address
+struct OledStats {
+    uint32_t transactions;
+    uint32_t bytes;         // Including address and control bytes
+    uint32_t dataBytes;     // GDDRAM bytes only
+};
+OledStats oledStats();
+void oledDump(FILE* out);   // Current GDDRAM as ASCII art
+
+// WLED stand-in: HTTP and the /ws WebSocket on 127.0.0.1:(80 + offset),
+// UDP realtime on 127.0.0.1:(21324 + offset). All outbound traffic from the
+// firmware is redirected there, whatever address config.h names.
+struct WledStats {
+    uint32_t connections;
+    uint32_t requests;
+    uint32_t transitions;           // Requests carrying a one-shot "tt" transition
+    uint32_t realtimeFrames;
+    uint32_t subscribers;           // Open /ws connections
+    uint32_t pushes;                // State messages sent to them
+    uint32_t infoRequests;          // GET /json/info
+    uint32_t catalogRequests;       // GET /json/eff and /json/pal
+    unsigned long lastRequestMs;    // millis() when the last request arrived
+    unsigned long lastFrameMs;
+    std::string lastBody;
+};
+uint16_t portOffset();
+void startWledStandIn();
+void setWledDelayMs(unsigned long delayMs);  // Emulate a slow node
+WledStats wledStats();
+// Change the node's state as the WLED app would; subscribers get a push
+void setWledState(int red, int green, int blue, int effect, int brightness);
+
+// Wi-Fi: an association takes WIFI_ASSOCIATE_MS and succeeds only while the
+// access point is up. Taking it down drops the station with a disconnect
+// event; the firmware has to reconnect by itself.
+constexpr unsigned long WIFI_ASSOCIATE_MS = 150;
+void setWifiAvailable(bool available);
+
+// NVS stand-in behind Preferences; persists across runs with SIM_NVS=<file>
+struct NvsStats {
+    uint32_t writes;        // putX() calls, each one a flash write on the device
+    uint32_t bytesWritten;
+    size_t keys;
+};
+// Whole store, or only the keys of one Preferences namespace
+NvsStats nvsStats(const char* space = nullptr);
+
+// Web server: run a registered route as if a client had requested it
+struct WebResponse {
+    int code;
+    std::string contentType;
+    std::string body;
+    std::map<std::string, std::string> headers;
+};
+WebResponse webRequest(const char* path,
+                       const std::vector<std::pair<std::string, std::string>>& headers = {});
+
+// Opens a Server-Sent Events client on a registered AsyncEventSource.
+// Returns an id for eventStream(), or -1 if there is no such endpoint.
+int openEventStream(const char* path);
+struct EventStream {
+    bool connected;
+    std::vector<std::string> messages;  // "event: data"
+};
+EventStream eventStream(int id);
+
+// Serial output goes to stdout unless muted
+void setSerialEnabled(bool enabled);
+
+}  // namespace sim
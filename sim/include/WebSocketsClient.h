@@ -0,0 +1,55 @@
+#pragma once
+
+#include <WiFi.h>
+#include <functional>
+#include <string>
+
+// Subset of the arduinoWebSockets (links2004) client: text frames over a
+// real loopback socket to the WLED stand-in. Like the library, all work,
+// including reconnects and event callbacks, happens inside loop().
+typedef enum {
+    WStype_ERROR,
+    WStype_DISCONNECTED,
+    WStype_CONNECTED,
+    WStype_TEXT,
+    WStype_BIN,
+    WStype_FRAGMENT_TEXT_START,
+    WStype_FRAGMENT_BIN_START,
+    WStype_FRAGMENT,
+    WStype_FRAGMENT_FIN,
+    WStype_PING,
+    WStype_PONG,
+} WStype_t;
+
+class WebSocketsClient {
+public:
+    typedef std::function<void(WStype_t type, uint8_t* payload, size_t length)> WebSocketClientEvent;
+
+    void begin(const char* host, uint16_t port, const char* url = "/", const char* protocol = "arduino");
+    void onEvent(WebSocketClientEvent event) { callback = event; }
+    void setReconnectInterval(unsigned long time) { reconnectIntervalMs = time; }
+    void enableHeartbeat(uint32_t pingInterval, uint32_t pongTimeout, uint8_t disconnectCount) {
+        (void)pingInterval; (void)pongTimeout; (void)disconnectCount;
+    }
+    void loop();
+    bool isConnected() { return open; }
+    bool sendTXT(const char* payload);
+    void disconnect();
+
+private:
+    WiFiClient client;
+    WebSocketClientEvent callback;
+    std::string host;
+    std::string url;
+    uint16_t port = 80;
+    unsigned long reconnectIntervalMs = 500;
+    unsigned long lastAttemptMs = 0;
+    bool started = false;
+    bool attempted = false;
+    bool open = false;
+    std::string received;
+
+    bool handshake();
+    bool readFrame();
+    void emit(WStype_t type, uint8_t* payload, size_t length) { if (callback) callback(type, payload, length); }
+};
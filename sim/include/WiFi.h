@@ -0,0 +1,98 @@
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+
+class IPAddress : public Printable {
+public:
+    IPAddress() : octets{0, 0, 0, 0} {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : octets{a, b, c, d} {}
+    bool fromString(const char* text);
+    String toString() const;
+    uint8_t operator[](int index) const { return octets[index]; }
+    operator uint32_t() const;
+    size_t printTo(Print& out) const override { return out.print(toString()); }
+
+private:
+    uint8_t octets[4];
+};
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+
+// The station events the firmware listens for, with the core's names
+typedef enum {
+    ARDUINO_EVENT_WIFI_STA_START = 2,
+    ARDUINO_EVENT_WIFI_STA_CONNECTED = 4,
+    ARDUINO_EVENT_WIFI_STA_DISCONNECTED = 5,
+    ARDUINO_EVENT_WIFI_STA_GOT_IP = 7,
+    ARDUINO_EVENT_WIFI_STA_LOST_IP = 8,
+    ARDUINO_EVENT_MAX = 64
+} arduino_event_id_t;
+typedef arduino_event_id_t WiFiEvent_t;
+
+typedef union {
+    struct { uint8_t reason; } wifi_sta_disconnected;
+} arduino_event_info_t;
+typedef arduino_event_info_t WiFiEventInfo_t;
+
+typedef std::function<void(arduino_event_id_t event, arduino_event_info_t info)> WiFiEventFuncCb;
+typedef size_t wifi_event_id_t;
+
+#define WIFI_REASON_BEACON_TIMEOUT 200
+#define WIFI_REASON_NO_AP_FOUND 201
+
+// TCP client on a real host socket. Every connection goes to 127.0.0.1 with
+// the port shifted by sim::portOffset(), where the WLED stand-in listens.
+// While the simulated Wi-Fi link is down, connects fail and open
+// connections read as closed.
+class WiFiClient : public Stream {
+public:
+    WiFiClient() {}
+    ~WiFiClient() { stop(); }
+    WiFiClient(const WiFiClient&) = delete;
+    WiFiClient& operator=(const WiFiClient&) = delete;
+
+    int connect(const char* host, uint16_t port, int32_t timeoutMs = 3000);
+    int connect(IPAddress ip, uint16_t port, int32_t timeoutMs = 3000);
+    uint8_t connected();
+    void stop();
+    int available() override;
+    int read() override;
+    int read(uint8_t* buffer, size_t size);
+    int peek() override;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    void setNoDelay(bool noDelay) { (void)noDelay; }
+    operator bool() { return connected(); }
+
+private:
+    int fd = -1;
+};
+
+class WiFiClass {
+public:
+    bool mode(wifi_mode_t newMode) { (void)newMode; return true; }
+    bool config(IPAddress local, IPAddress gateway, IPAddress subnet) { (void)local; (void)gateway; (void)subnet; return true; }
+    wl_status_t begin(const char* ssid, const char* password);
+    bool reconnect();
+    bool disconnect(bool wifiOff = false);
+    wl_status_t status();
+    IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+    int8_t RSSI() { return -50; }
+    void setAutoReconnect(bool autoReconnect) { (void)autoReconnect; }
+    wifi_event_id_t onEvent(WiFiEventFuncCb callback, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+    void persistent(bool persistent) { (void)persistent; }
+    void setSleep(bool sleep) { (void)sleep; }
+};
+
+extern WiFiClass WiFi;
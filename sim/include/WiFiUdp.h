@@ -0,0 +1,26 @@
+#pragma once
+
+#include <WiFi.h>
+#include <vector>
+
+// UDP sender on a host socket, redirected like WiFiClient
+class WiFiUDP : public Stream {
+public:
+    ~WiFiUDP() { stop(); }
+    uint8_t begin(uint16_t port) { (void)port; return 1; }
+    int beginPacket(IPAddress ip, uint16_t port);
+    int beginPacket(const char* host, uint16_t port);
+    int endPacket();
+    size_t write(uint8_t c) override { packet.push_back(c); return 1; }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        packet.insert(packet.end(), buffer, buffer + size);
+        return size;
+    }
+    using Print::write;
+    void stop();
+
+private:
+    int fd = -1;
+    uint16_t destinationPort = 0;
+    std::vector<uint8_t> packet;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+
+// I2C master. Transactions addressed to the SSD1306 are decoded by the
+// simulator's display model (Sim.h); everything else is acknowledged and dropped.
+class TwoWire : public Stream {
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    void setClock(uint32_t frequency) { clock = frequency; }
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(bool sendStop = true);
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+private:
+    uint32_t clock = 100000;
+    uint8_t txAddress = 0;
+    std::vector<uint8_t> txBuffer;
+};
+
+extern TwoWire Wire;
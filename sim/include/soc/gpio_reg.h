@@ -0,0 +1,6 @@
+#pragma once
+
+// ESP32-S2 GPIO input levels: GPIO0-31, then GPIO32-53
+#define DR_REG_GPIO_BASE 0x3f404000
+#define GPIO_IN_REG      (DR_REG_GPIO_BASE + 0x003c)
+#define GPIO_IN1_REG     (DR_REG_GPIO_BASE + 0x0040)
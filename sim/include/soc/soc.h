@@ -0,0 +1,9 @@
+#pragma once
+
+#include <stdint.h>
+
+// Register reads go to the simulated pin bank; only the GPIO input
+// registers in soc/gpio_reg.h are modelled
+uint32_t simRegisterRead(uint32_t address);
+
+#define REG_READ(reg) simRegisterRead(reg)
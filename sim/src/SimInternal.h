@@ -0,0 +1,18 @@
+#pragma once
+
+// Shared between the simulator's translation units; not visible to firmware
+
+#include <mutex>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace sim {
+
+// Models "interrupts disabled": held while an ISR runs, inside
+// noInterrupts()/interrupts() and inside every portENTER_CRITICAL section
+std::recursive_mutex& interruptLock();
+
+// Feeds a finished I2C transaction to the SSD1306 model
+void displayTransaction(uint8_t address, const uint8_t* data, size_t length);
+
+}  // namespace sim
@@ -0,0 +1,230 @@
+#include <Arduino.h>
+#include <Sim.h>
+#include <soc/soc.h>
+#include <soc/gpio_reg.h>
+#include "SimInternal.h"
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+namespace {
+
+const auto startTime = std::chrono::steady_clock::now();
+std::atomic<bool> serialEnabled(true);
+
+struct PinState {
+    std::atomic<int> level{HIGH};
+    void (*handler)() = nullptr;
+    void (*argHandler)(void*) = nullptr;
+    void* arg = nullptr;
+    int mode = 0;
+};
+
+PinState pins[sim::PIN_COUNT];
+
+}  // namespace
+
+namespace sim {
+
+std::recursive_mutex& interruptLock() {
+    static std::recursive_mutex lock;
+    return lock;
+}
+
+void setSerialEnabled(bool enabled) { serialEnabled = enabled; }
+
+void setPin(uint8_t pin, int level) {
+    if (pin >= PIN_COUNT) return;
+    PinState& state = pins[pin];
+    const int previous = state.level.exchange(level ? HIGH : LOW);
+    if (previous == (level ? HIGH : LOW)) return;
+    if (state.handler == nullptr && state.argHandler == nullptr) return;
+
+    const bool rising = level != 0;
+    if (state.mode == CHANGE || (state.mode == RISING && rising) || (state.mode == FALLING && !rising)) {
+        std::lock_guard<std::recursive_mutex> isr(interruptLock());
+        if (state.argHandler != nullptr) state.argHandler(state.arg);
+        else if (state.handler != nullptr) state.handler();
+    }
+}
+
+int getPin(uint8_t pin) {
+    return pin < PIN_COUNT ? pins[pin].level.load() : LOW;
+}
+
+void sleepUs(unsigned long us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void turnEncoder(uint8_t pinA, uint8_t pinB, int detents, unsigned long edgeIntervalUs) {
+    // Gray sequence from the rest position (both high); reversed for the other direction
+    static const uint8_t sequence[4][2] = {{LOW, HIGH}, {LOW, LOW}, {HIGH, LOW}, {HIGH, HIGH}};
+    const bool forward = detents > 0;
+    for (int d = 0; d < abs(detents); d++) {
+        for (int edge = 0; edge < 4; edge++) {
+            const uint8_t* levels = sequence[forward ? edge : (2 - edge + 4) % 4];
+            setPin(pinA, levels[0]);
+            setPin(pinB, levels[1]);
+            sleepUs(edgeIntervalUs);
+        }
+    }
+}
+
+void pressButton(uint8_t pin, unsigned long holdMs, int bounces, unsigned long bounceUs) {
+    for (int level : {LOW, HIGH}) {
+        for (int b = 0; b < bounces; b++) {
+            setPin(pin, level);
+            sleepUs(bounceUs);
+            setPin(pin, !level);
+            sleepUs(bounceUs);
+        }
+        setPin(pin, level);
+        if (level == LOW) sleepUs(holdMs * 1000);
+    }
+}
+
+}  // namespace sim
+
+String::String(double value, unsigned int decimals) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.*f", static_cast<int>(decimals), value);
+    assign(text);
+}
+
+size_t Print::print(long value, int base) {
+    char text[24];
+    snprintf(text, sizeof(text), base == HEX ? "%lx" : "%ld", value);
+    return write(text);
+}
+
+size_t Print::print(unsigned long value, int base) {
+    char text[24];
+    snprintf(text, sizeof(text), base == HEX ? "%lx" : "%lu", value);
+    return write(text);
+}
+
+size_t Print::print(double value, int digits) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    return write(text);
+}
+
+size_t Print::printf(const char* format, ...) {
+    char text[512];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (length < 0) return 0;
+    return write(reinterpret_cast<const uint8_t*>(text), min(static_cast<size_t>(length), sizeof(text) - 1));
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (serialEnabled) fputc(c, stdout);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    if (serialEnabled) fwrite(buffer, 1, size, stdout);
+    return size;
+}
+
+uint32_t esp_random() {
+    static std::random_device source;
+    return source();
+}
+
+unsigned long millis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long micros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us) {
+    // Busy-wait like the real one; it is also called from ISRs
+    const unsigned long start = micros();
+    while (micros() - start < us) {}
+}
+
+void yield() {
+    std::this_thread::yield();
+}
+
+uint32_t simRegisterRead(uint32_t address) {
+    uint8_t firstPin;
+    if (address == GPIO_IN_REG) firstPin = 0;
+    else if (address == GPIO_IN1_REG) firstPin = 32;
+    else return 0;
+
+    uint32_t levels = 0;
+    for (uint8_t bit = 0; bit < 32 && firstPin + bit < sim::PIN_COUNT; bit++) {
+        if (pins[firstPin + bit].level.load() != LOW) levels |= 1UL << bit;
+    }
+    return levels;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < sim::PIN_COUNT && mode == INPUT_PULLUP) pins[pin].level = HIGH;
+}
+
+int digitalRead(uint8_t pin) {
+    return sim::getPin(pin);
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin < sim::PIN_COUNT) pins[pin].level = value ? HIGH : LOW;
+}
+
+void attachInterrupt(int pin, void (*handler)(), int mode) {
+    if (pin < 0 || pin >= sim::PIN_COUNT) return;
+    std::lock_guard<std::recursive_mutex> isr(sim::interruptLock());
+    pins[pin].handler = handler;
+    pins[pin].argHandler = nullptr;
+    pins[pin].arg = nullptr;
+    pins[pin].mode = mode;
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode) {
+    if (pin >= sim::PIN_COUNT) return;
+    std::lock_guard<std::recursive_mutex> isr(sim::interruptLock());
+    pins[pin].handler = nullptr;
+    pins[pin].argHandler = handler;
+    pins[pin].arg = arg;
+    pins[pin].mode = mode;
+}
+
+void detachInterrupt(int pin) {
+    attachInterrupt(pin, nullptr, 0);
+}
+
+void noInterrupts() {
+    sim::interruptLock().lock();
+}
+
+void interrupts() {
+    sim::interruptLock().unlock();
+}
+
+uint32_t EspClass::getCycleCount() {
+    // 240 MHz core clock
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - startTime).count() * 240 / 1000);
+}
+
+void EspClass::restart() {
+    fflush(stdout);
+    exit(0);
+}
@@ -0,0 +1,261 @@
+#include <Adafruit_SSD1306.h>
+#include <Sim.h>
+#include "SimInternal.h"
+
+TwoWire Wire;
+
+namespace {
+
+constexpr uint8_t DISPLAY_ADDRESS = 0x3C;
+constexpr int OLED_WIDTH = 128;
+constexpr int OLED_PAGES = 8;
+
+// SSD1306 in horizontal addressing mode: data bytes fill the column/page
+// window set by COLUMNADDR/PAGEADDR and wrap inside it
+struct OledModel {
+    std::mutex lock;
+    uint8_t gddram[OLED_PAGES][OLED_WIDTH] = {};
+    int columnStart = 0, columnEnd = OLED_WIDTH - 1;
+    int pageStart = 0, pageEnd = OLED_PAGES - 1;
+    int column = 0, page = 0;
+    uint8_t command = 0;        // Command waiting for arguments
+    int argumentsLeft = 0;
+    uint8_t arguments[6] = {};
+    int argumentCount = 0;
+    sim::OledStats stats = {};
+
+    static int argumentsFor(uint8_t c) {
+        switch (c) {
+            case 0x21: case 0x22: case 0xA3: return 2;
+            case 0x26: case 0x27: return 6;
+            case 0x29: case 0x2A: return 5;
+            case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+            case 0xD5: case 0xD9: case 0xDA: case 0xDB: return 1;
+            default: return 0;
+        }
+    }
+
+    void applyCommand() {
+        if (command == 0x21) {
+            columnStart = min<int>(arguments[0], OLED_WIDTH - 1);
+            columnEnd = min<int>(arguments[1], OLED_WIDTH - 1);
+            column = columnStart;
+        } else if (command == 0x22) {
+            pageStart = min<int>(arguments[0], OLED_PAGES - 1);
+            pageEnd = min<int>(arguments[1], OLED_PAGES - 1);
+            page = pageStart;
+        }
+    }
+
+    void commandByte(uint8_t c) {
+        if (argumentsLeft > 0) {
+            arguments[argumentCount++] = c;
+            if (--argumentsLeft == 0) applyCommand();
+            return;
+        }
+        command = c;
+        argumentCount = 0;
+        argumentsLeft = argumentsFor(c);
+        if (argumentsLeft == 0) applyCommand();
+    }
+
+    void dataByte(uint8_t d) {
+        gddram[page][column] = d;
+        if (++column > columnEnd) {
+            column = columnStart;
+            if (++page > pageEnd) page = pageStart;
+        }
+        stats.dataBytes++;
+    }
+};
+
+OledModel oled;
+
+}  // namespace
+
+namespace sim {
+
+void displayTransaction(uint8_t address, const uint8_t* data, size_t length) {
+    if (address != DISPLAY_ADDRESS || length == 0) return;
+    std::lock_guard<std::mutex> guard(oled.lock);
+    oled.stats.transactions++;
+    oled.stats.bytes += length + 1;  // Plus the address byte
+
+    // Control byte: Co = 0, D/C# selects command or data for the rest
+    const bool isData = data[0] & 0x40;
+    for (size_t i = 1; i < length; i++) {
+        if (isData) {
+            oled.dataByte(data[i]);
+        } else {
+            oled.commandByte(data[i]);
+        }
+    }
+}
+
+OledStats oledStats() {
+    std::lock_guard<std::mutex> guard(oled.lock);
+    return oled.stats;
+}
+
+void oledDump(FILE* out) {
+    std::lock_guard<std::mutex> guard(oled.lock);
+    for (int y = 0; y < OLED_PAGES * 8; y += 2) {
+        for (int x = 0; x < OLED_WIDTH; x++) {
+            const bool top = oled.gddram[y / 8][x] & (1 << (y % 8));
+            const bool bottom = oled.gddram[(y + 1) / 8][x] & (1 << ((y + 1) % 8));
+            fputc(top && bottom ? '#' : top ? '"' : bottom ? '.' : ' ', out);
+        }
+        fputc('\n', out);
+    }
+}
+
+}  // namespace sim
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+    (void)sda;
+    (void)scl;
+    if (frequency) clock = frequency;
+    return true;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    txAddress = address;
+    txBuffer.clear();
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    (void)sendStop;
+    sim::displayTransaction(txAddress, txBuffer.data(), txBuffer.size());
+    // Bus time at the configured clock: 9 bits per byte including the ACK
+    sim::sleepUs((txBuffer.size() + 1) * 9 * 1000000UL / clock);
+    txBuffer.clear();
+    return 0;
+}
+
+size_t TwoWire::write(uint8_t c) {
+    if (txBuffer.size() >= 128) return 0;  // ESP32 Wire buffer size
+    txBuffer.push_back(c);
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (written < size && write(buffer[written])) written++;
+    return written;
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    for (int16_t i = 0; i < w; i++) drawPixel(x + i, y, color);
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    for (int16_t i = 0; i < h; i++) drawPixel(x, y + i, color);
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    for (int16_t i = 0; i < w; i++) drawFastVLine(x + i, y, h, color);
+}
+
+void Adafruit_GFX::getTextBounds(const char* text, int16_t x, int16_t y,
+                                 int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
+    *x1 = x;
+    *y1 = y;
+    *w = strlen(text) * 6 * textSize;
+    *h = 8 * textSize;
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+    if (c == '\n') {
+        cursorX = 0;
+        cursorY += 8 * textSize;
+        return 1;
+    }
+    if (c == '\r') return 1;
+    if (textWrap && cursorX + 6 * textSize > _width) {
+        cursorX = 0;
+        cursorY += 8 * textSize;
+    }
+
+    // Placeholder glyph: five columns of seven rows picked from the character code
+    for (int column = 0; column < 5; column++) {
+        const uint8_t bits = c == ' ' ? 0 : static_cast<uint8_t>((c * (column + 3) * 37) >> 2) | 0x41;
+        for (int row = 0; row < 8; row++) {
+            const bool on = row < 7 && (bits & (1 << row));
+            if (on || textBackground != textColor) {
+                fillRect(cursorX + column * textSize, cursorY + row * textSize,
+                         textSize, textSize, on ? textColor : textBackground);
+            }
+        }
+    }
+    cursorX += 6 * textSize;
+    return 1;
+}
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi, int8_t resetPin)
+    : Adafruit_GFX(w, h), wire(twi), buffer(new uint8_t[w * ((h + 7) / 8)]()), i2cAddress(0) {
+    (void)resetPin;
+}
+
+Adafruit_SSD1306::~Adafruit_SSD1306() {
+    delete[] buffer;
+}
+
+bool Adafruit_SSD1306::begin(uint8_t vcs, uint8_t address) {
+    (void)vcs;
+    i2cAddress = address;
+    const uint8_t init[] = {SSD1306_DISPLAYOFF, SSD1306_MEMORYMODE, 0x00, SSD1306_DISPLAYON};
+    wire->beginTransmission(i2cAddress);
+    wire->write((uint8_t)0x00);
+    wire->write(init, sizeof(init));
+    wire->endTransmission();
+    clearDisplay();
+    return true;
+}
+
+void Adafruit_SSD1306::ssd1306_command(uint8_t c) {
+    wire->beginTransmission(i2cAddress);
+    wire->write((uint8_t)0x00);
+    wire->write(c);
+    wire->endTransmission();
+}
+
+void Adafruit_SSD1306::display() {
+    const uint8_t window[] = {SSD1306_PAGEADDR, 0, 0xFF, SSD1306_COLUMNADDR, 0};
+    wire->beginTransmission(i2cAddress);
+    wire->write((uint8_t)0x00);
+    wire->write(window, sizeof(window));
+    wire->endTransmission();
+    ssd1306_command(_width - 1);
+
+    const size_t size = _width * ((_height + 7) / 8);
+    for (size_t offset = 0; offset < size;) {
+        const size_t chunk = min<size_t>(127, size - offset);
+        wire->beginTransmission(i2cAddress);
+        wire->write((uint8_t)0x40);
+        wire->write(buffer + offset, chunk);
+        wire->endTransmission();
+        offset += chunk;
+    }
+}
+
+void Adafruit_SSD1306::clearDisplay() {
+    memset(buffer, 0, _width * ((_height + 7) / 8));
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+    uint8_t& cell = buffer[x + (y / 8) * _width];
+    const uint8_t bit = 1 << (y & 7);
+    switch (color) {
+        case SSD1306_WHITE: cell |= bit; break;
+        case SSD1306_BLACK: cell &= ~bit; break;
+        case SSD1306_INVERSE: cell ^= bit; break;
+    }
+}
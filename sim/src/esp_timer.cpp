@@ -0,0 +1,57 @@
+#include <Arduino.h>
+#include <esp_timer.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+struct SimTimer {
+    esp_timer_create_args_t args;
+    std::atomic<bool> running{false};
+    std::atomic<uint32_t> generation{0};   // A stopped timer's thread sees a newer one and exits
+};
+
+namespace {
+
+void runPeriodic(SimTimer* timer, uint64_t periodUs, uint32_t generation) {
+    auto next = std::chrono::steady_clock::now();
+    while (timer->running && timer->generation == generation) {
+        next += std::chrono::microseconds(periodUs);
+        std::this_thread::sleep_until(next);
+        if (!timer->running || timer->generation != generation) break;
+        timer->args.callback(timer->args.arg);
+
+        // Like skip_unhandled_events: a late callback is not caught up on
+        const auto now = std::chrono::steady_clock::now();
+        if (timer->args.skip_unhandled_events && now > next + std::chrono::microseconds(periodUs)) {
+            next = now;
+        }
+    }
+}
+
+}  // namespace
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+    if (args == nullptr || args->callback == nullptr || handle == nullptr) return ESP_ERR_INVALID_ARG;
+    SimTimer* timer = new SimTimer();
+    timer->args = *args;
+    *handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+    if (timer == nullptr || periodUs == 0) return ESP_ERR_INVALID_ARG;
+    if (timer->running.exchange(true)) return ESP_ERR_INVALID_STATE;
+    std::thread(runPeriodic, timer, periodUs, ++timer->generation).detach();
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (timer == nullptr || !timer->running.exchange(false)) return ESP_ERR_INVALID_STATE;
+    timer->generation++;
+    return ESP_OK;
+}
+
+int64_t esp_timer_get_time() {
+    return micros();
+}
@@ -0,0 +1,175 @@
+#include <Arduino.h>
+#include "SimInternal.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct SimTask {
+    std::string name;
+    std::mutex lock;
+    std::condition_variable wake;
+    uint32_t notifications = 0;
+};
+
+struct SimQueue {
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<std::vector<uint8_t>> items;
+    size_t length;
+    size_t itemSize;
+};
+
+namespace {
+
+// The Arduino loop task, and any other thread the simulator did not create
+thread_local SimTask* currentTask = nullptr;
+
+SimTask* self() {
+    if (currentTask == nullptr) {
+        currentTask = new SimTask();
+        currentTask->name = "loopTask";
+    }
+    return currentTask;
+}
+
+template <typename Predicate>
+bool waitFor(std::condition_variable& cv, std::unique_lock<std::mutex>& guard,
+             TickType_t ticks, Predicate ready) {
+    if (ticks == portMAX_DELAY) {
+        cv.wait(guard, ready);
+        return true;
+    }
+    return cv.wait_for(guard, std::chrono::milliseconds(ticks), ready);
+}
+
+}  // namespace
+
+void vPortEnterCritical(portMUX_TYPE* mux) {
+    (void)mux;
+    sim::interruptLock().lock();
+}
+
+void vPortExitCritical(portMUX_TYPE* mux) {
+    (void)mux;
+    sim::interruptLock().unlock();
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                       void* parameter, UBaseType_t priority, TaskHandle_t* handle) {
+    (void)stackDepth;
+    (void)priority;
+    SimTask* task = new SimTask();
+    task->name = name;
+    if (handle) *handle = task;
+
+    std::thread([task, function, parameter]() {
+        currentTask = task;
+        function(parameter);
+    }).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                                   void* parameter, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core) {
+    (void)core;
+    return xTaskCreate(function, name, stackDepth, parameter, priority, handle);
+}
+
+void vTaskDelete(TaskHandle_t handle) {
+    // Only self-deletion is used; the thread simply returns afterwards
+    (void)handle;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+TickType_t xTaskGetTickCount() {
+    return millis();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return self();
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t handle) {
+    {
+        std::lock_guard<std::mutex> guard(handle->lock);
+        handle->notifications++;
+    }
+    handle->wake.notify_one();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t handle, BaseType_t* higherPriorityTaskWoken) {
+    xTaskNotifyGive(handle);
+    if (higherPriorityTaskWoken) *higherPriorityTaskWoken = pdFALSE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait) {
+    SimTask* task = self();
+    std::unique_lock<std::mutex> guard(task->lock);
+    if (!waitFor(task->wake, guard, ticksToWait, [task] { return task->notifications > 0; })) {
+        return 0;
+    }
+    uint32_t value = task->notifications;
+    task->notifications = clearOnExit ? 0 : value - 1;
+    return value;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    SimQueue* queue = new SimQueue();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> guard(queue->lock);
+    if (!waitFor(queue->changed, guard, ticksToWait,
+                 [queue] { return queue->items.size() < queue->length; })) {
+        return pdFALSE;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(item);
+    queue->items.emplace_back(bytes, bytes + queue->itemSize);
+    guard.unlock();
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higherPriorityTaskWoken) {
+    if (higherPriorityTaskWoken) *higherPriorityTaskWoken = pdFALSE;
+    return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item) {
+    std::unique_lock<std::mutex> guard(queue->lock);
+    const uint8_t* bytes = static_cast<const uint8_t*>(item);
+    queue->items.clear();
+    queue->items.emplace_back(bytes, bytes + queue->itemSize);
+    guard.unlock();
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> guard(queue->lock);
+    if (!waitFor(queue->changed, guard, ticksToWait, [queue] { return !queue->items.empty(); })) {
+        return pdFALSE;
+    }
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    guard.unlock();
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> guard(queue->lock);
+    return queue->items.size();
+}
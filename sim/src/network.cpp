@@ -0,0 +1,418 @@
+#include <HTTPClient.h>
+#include <WiFiUdp.h>
+#include <Sim.h>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+WiFiClass WiFi;
+
+namespace {
+
+std::atomic<bool> accessPointUp(true);
+std::atomic<wl_status_t> stationStatus(WL_DISCONNECTED);
+std::atomic<uint32_t> associationId(0);     // Newer begin() calls supersede older ones
+std::mutex eventLock;
+std::vector<std::pair<WiFiEventFuncCb, arduino_event_id_t>>& eventHandlers() {
+    static std::vector<std::pair<WiFiEventFuncCb, arduino_event_id_t>> handlers;
+    return handlers;
+}
+
+// Like the core's event task: handlers run on a thread of their own
+void raiseEvent(arduino_event_id_t event, uint8_t reason = 0) {
+    std::vector<std::pair<WiFiEventFuncCb, arduino_event_id_t>> handlers;
+    {
+        std::lock_guard<std::mutex> guard(eventLock);
+        handlers = eventHandlers();
+    }
+    arduino_event_info_t info = {};
+    info.wifi_sta_disconnected.reason = reason;
+    for (auto& handler : handlers) {
+        if (handler.second == ARDUINO_EVENT_MAX || handler.second == event) handler.first(event, info);
+    }
+}
+
+bool linkUp() {
+    return stationStatus == WL_CONNECTED;
+}
+
+sockaddr_in loopback(uint16_t port) {
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port + sim::portOffset());
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return address;
+}
+
+}  // namespace
+
+namespace sim {
+
+uint16_t portOffset() {
+    static const uint16_t offset = [] {
+        const char* value = getenv("SIM_PORT_OFFSET");
+        return static_cast<uint16_t>(value ? atoi(value) : 8000);
+    }();
+    return offset;
+}
+
+void setWifiAvailable(bool available) {
+    accessPointUp = available;
+    if (!available && stationStatus.exchange(WL_CONNECTION_LOST) == WL_CONNECTED) {
+        std::thread(raiseEvent, ARDUINO_EVENT_WIFI_STA_DISCONNECTED, WIFI_REASON_BEACON_TIMEOUT).detach();
+    }
+}
+
+}  // namespace sim
+
+// IPAddress
+
+bool IPAddress::fromString(const char* text) {
+    unsigned int a, b, c, d;
+    char trailing;
+    if (sscanf(text, "%u.%u.%u.%u%c", &a, &b, &c, &d, &trailing) != 4 ||
+        a > 255 || b > 255 || c > 255 || d > 255) {
+        return false;
+    }
+    octets[0] = a;
+    octets[1] = b;
+    octets[2] = c;
+    octets[3] = d;
+    return true;
+}
+
+String IPAddress::toString() const {
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+    return String(text);
+}
+
+IPAddress::operator uint32_t() const {
+    return octets[0] | (octets[1] << 8) | (octets[2] << 16) | (static_cast<uint32_t>(octets[3]) << 24);
+}
+
+// WiFi: associates after sim::WIFI_ASSOCIATE_MS if the access point is up
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* password) {
+    (void)ssid;
+    (void)password;
+    stationStatus = WL_DISCONNECTED;
+    const uint32_t id = ++associationId;
+    std::thread([id] {
+        delay(sim::WIFI_ASSOCIATE_MS);
+        if (id != associationId) return;
+        if (accessPointUp) {
+            stationStatus = WL_CONNECTED;
+            raiseEvent(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+        } else {
+            stationStatus = WL_NO_SSID_AVAIL;
+            raiseEvent(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, WIFI_REASON_NO_AP_FOUND);
+        }
+    }).detach();
+    return WL_DISCONNECTED;
+}
+
+bool WiFiClass::reconnect() { return begin(nullptr, nullptr) != WL_CONNECT_FAILED; }
+
+bool WiFiClass::disconnect(bool wifiOff) {
+    (void)wifiOff;
+    ++associationId;
+    stationStatus = WL_DISCONNECTED;
+    return true;
+}
+
+wl_status_t WiFiClass::status() { return stationStatus; }
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventFuncCb callback, arduino_event_id_t event) {
+    std::lock_guard<std::mutex> guard(eventLock);
+    eventHandlers().emplace_back(callback, event);
+    return eventHandlers().size();
+}
+
+// WiFiClient
+
+int WiFiClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+    (void)host;
+    stop();
+    if (!linkUp()) return 0;
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return 0;
+
+    const int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    // Non-blocking connect so the timeout is honoured like lwIP's
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    sockaddr_in address = loopback(port);
+    int result = ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    if (result < 0 && errno == EINPROGRESS) {
+        pollfd pending = {fd, POLLOUT, 0};
+        int error = 0;
+        socklen_t length = sizeof(error);
+        if (poll(&pending, 1, timeoutMs) == 1 &&
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0) {
+            result = 0;
+        }
+    }
+    if (result < 0) {
+        stop();
+        return 0;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    return 1;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port, int32_t timeoutMs) {
+    return connect(ip.toString().c_str(), port, timeoutMs);
+}
+
+uint8_t WiFiClient::connected() {
+    if (fd < 0) return 0;
+    if (!linkUp()) {
+        stop();
+        return 0;
+    }
+    // Peer closed and nothing left to read: the connection is gone
+    char probe;
+    ssize_t result = recv(fd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (result == 0 || (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+void WiFiClient::stop() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+int WiFiClient::available() {
+    if (fd < 0) return 0;
+    int count = 0;
+    return ioctl(fd, FIONREAD, &count) == 0 ? count : 0;
+}
+
+int WiFiClient::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+    if (fd < 0) return -1;
+    ssize_t result = recv(fd, buffer, size, MSG_DONTWAIT);
+    return result > 0 ? static_cast<int>(result) : -1;
+}
+
+int WiFiClient::peek() {
+    if (fd < 0) return -1;
+    uint8_t c;
+    return recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 1 ? c : -1;
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+    if (fd < 0 || !linkUp()) return 0;
+    ssize_t result = send(fd, buffer, size, MSG_NOSIGNAL);
+    return result > 0 ? static_cast<size_t>(result) : 0;
+}
+
+// WiFiUDP
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+    (void)ip;
+    if (fd < 0) fd = socket(AF_INET, SOCK_DGRAM, 0);
+    destinationPort = port;
+    packet.clear();
+    return fd >= 0;
+}
+
+int WiFiUDP::beginPacket(const char* host, uint16_t port) {
+    (void)host;
+    return beginPacket(IPAddress(), port);
+}
+
+int WiFiUDP::endPacket() {
+    if (fd < 0 || !linkUp()) {
+        packet.clear();
+        return 0;
+    }
+    sockaddr_in address = loopback(destinationPort);
+    ssize_t result = sendto(fd, packet.data(), packet.size(), 0,
+                            reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    packet.clear();
+    return result >= 0;
+}
+
+void WiFiUDP::stop() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+// HTTPClient
+
+bool HTTPClient::begin(String url) {
+    return begin(ownClient, url);
+}
+
+bool HTTPClient::begin(WiFiClient& client, String url) {
+    // http://host[:port]/path
+    size_t start = url.find("://");
+    start = start == std::string::npos ? 0 : start + 3;
+    size_t slash = url.find('/', start);
+    String authority = url.substring(start, slash == std::string::npos ? ~0u : slash);
+    String path = slash == std::string::npos ? String("/") : url.substring(slash);
+    size_t colon = authority.find(':');
+    uint16_t urlPort = 80;
+    if (colon != std::string::npos) {
+        urlPort = static_cast<uint16_t>(atoi(authority.c_str() + colon + 1));
+        authority = authority.substring(0, colon);
+    }
+    return begin(client, authority, urlPort, path);
+}
+
+bool HTTPClient::begin(WiFiClient& client, String host, uint16_t port, String uri, bool https) {
+    (void)https;
+    if (this->client != &client || this->host != host || this->port != port) {
+        if (this->client) this->client->stop();
+        canReuse = false;
+    }
+    this->client = &client;
+    this->host = host;
+    this->port = port;
+    this->uri = uri;
+    headers.clear();
+    return true;
+}
+
+void HTTPClient::end() {
+    // Keep the socket for the next request only if both sides agreed to
+    if (client && (!reuse || !canReuse)) client->stop();
+    headers.clear();
+    size = -1;
+}
+
+void HTTPClient::addHeader(const String& name, const String& value) {
+    headers += name + ": " + value + "\r\n";
+}
+
+bool HTTPClient::connected() {
+    return client && client->connected();
+}
+
+int HTTPClient::GET() {
+    return sendRequest("GET", nullptr, 0);
+}
+
+int HTTPClient::POST(uint8_t* payload, size_t size) {
+    return sendRequest("POST", payload, size);
+}
+
+int HTTPClient::sendRequest(const char* method, const uint8_t* payload, size_t length) {
+    if (client == nullptr) return HTTPC_ERROR_NOT_CONNECTED;
+    size = -1;
+
+    if (!client->connected() && !client->connect(host.c_str(), port, connectTimeout)) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+
+    String request = String(method) + " " + uri + (useHttp10 ? " HTTP/1.0\r\n" : " HTTP/1.1\r\n");
+    request += "Host: " + host + "\r\n";
+    request += String("Connection: ") + (reuse ? "keep-alive" : "close") + "\r\n";
+    request += headers;
+    request += "Content-Length: " + String(static_cast<unsigned long>(length)) + "\r\n\r\n";
+    if (client->write(reinterpret_cast<const uint8_t*>(request.data()), request.size()) != request.size()) {
+        client->stop();
+        return HTTPC_ERROR_SEND_HEADER_FAILED;
+    }
+    if (length > 0 && client->write(payload, length) != length) {
+        client->stop();
+        return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+    }
+    return readResponseHeaders();
+}
+
+bool HTTPClient::readLine(String& line) {
+    line.clear();
+    unsigned long start = millis();
+    while (millis() - start < timeout) {
+        int c = client->read();
+        if (c < 0) {
+            if (!client->connected()) return false;
+            delay(1);
+            continue;
+        }
+        if (c == '\n') return true;
+        if (c != '\r') line += static_cast<char>(c);
+    }
+    return false;
+}
+
+int HTTPClient::readResponseHeaders() {
+    String line;
+    if (!readLine(line)) {
+        const bool timedOut = client->connected();
+        client->stop();
+        return timedOut ? HTTPC_ERROR_READ_TIMEOUT : HTTPC_ERROR_CONNECTION_LOST;
+    }
+    int code = 0;
+    if (sscanf(line.c_str(), "HTTP/%*d.%*d %d", &code) != 1) {
+        client->stop();
+        return HTTPC_ERROR_NO_HTTP_SERVER;
+    }
+
+    canReuse = reuse && !useHttp10;
+    while (readLine(line) && !line.empty()) {
+        String lower = line;
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        if (lower.rfind("content-length:", 0) == 0) {
+            size = atoi(line.c_str() + 15);
+        } else if (lower.rfind("connection:", 0) == 0 && lower.find("close") != std::string::npos) {
+            canReuse = false;
+        }
+    }
+    return code;
+}
+
+String HTTPClient::getString() {
+    String body;
+    unsigned long start = millis();
+    while ((size < 0 || static_cast<int>(body.size()) < size) && millis() - start < timeout) {
+        int c = client->read();
+        if (c < 0) {
+            if (!client->connected()) break;
+            delay(1);
+            continue;
+        }
+        body += static_cast<char>(c);
+    }
+    return body;
+}
+
+String HTTPClient::errorToString(int error) {
+    switch (error) {
+        case HTTPC_ERROR_CONNECTION_REFUSED: return "connection refused";
+        case HTTPC_ERROR_SEND_HEADER_FAILED: return "send header failed";
+        case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return "send payload failed";
+        case HTTPC_ERROR_NOT_CONNECTED: return "not connected";
+        case HTTPC_ERROR_CONNECTION_LOST: return "connection lost";
+        case HTTPC_ERROR_NO_HTTP_SERVER: return "no HTTP server";
+        case HTTPC_ERROR_READ_TIMEOUT: return "read Timeout";
+        default: return String();
+    }
+}
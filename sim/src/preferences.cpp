@@ -0,0 +1,151 @@
+#include <Preferences.h>
+#include <Sim.h>
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+// NVS stand-in. Every write is counted, so scenarios can check how often
+// the firmware would have touched flash. With SIM_NVS set, the store is
+// loaded from that file at start and rewritten after every change.
+
+namespace {
+
+std::mutex storeLock;
+std::map<std::string, std::vector<uint8_t>> entries;
+sim::NvsStats stats = {};
+std::map<std::string, sim::NvsStats> spaceStats;   // Writes per namespace
+bool loaded = false;
+
+const char* storePath() {
+    return getenv("SIM_NVS");
+}
+
+// Caller holds storeLock
+void load() {
+    if (loaded) return;
+    loaded = true;
+    const char* path = storePath();
+    FILE* file = path ? fopen(path, "rb") : nullptr;
+    if (!file) return;
+    uint32_t keyLength;
+    uint32_t valueLength;
+    while (fread(&keyLength, sizeof(keyLength), 1, file) == 1) {
+        std::string key(keyLength, '\0');
+        if (fread(&key[0], 1, keyLength, file) != keyLength ||
+            fread(&valueLength, sizeof(valueLength), 1, file) != 1) {
+            break;
+        }
+        std::vector<uint8_t> value(valueLength);
+        if (fread(value.data(), 1, valueLength, file) != valueLength) break;
+        entries[key] = value;
+    }
+    fclose(file);
+}
+
+// Caller holds storeLock
+void save() {
+    const char* path = storePath();
+    FILE* file = path ? fopen(path, "wb") : nullptr;
+    if (!file) return;
+    for (const auto& entry : entries) {
+        const uint32_t keyLength = entry.first.size();
+        const uint32_t valueLength = entry.second.size();
+        fwrite(&keyLength, sizeof(keyLength), 1, file);
+        fwrite(entry.first.data(), 1, keyLength, file);
+        fwrite(&valueLength, sizeof(valueLength), 1, file);
+        fwrite(entry.second.data(), 1, valueLength, file);
+    }
+    fclose(file);
+}
+
+}  // namespace
+
+namespace sim {
+
+NvsStats nvsStats(const char* space) {
+    std::lock_guard<std::mutex> guard(storeLock);
+    load();
+    if (space == nullptr) {
+        NvsStats copy = stats;
+        copy.keys = entries.size();
+        return copy;
+    }
+    NvsStats copy = spaceStats[space];
+    const std::string prefix = std::string(space) + "/";
+    copy.keys = 0;
+    for (const auto& entry : entries) {
+        if (entry.first.compare(0, prefix.size(), prefix) == 0) copy.keys++;
+    }
+    return copy;
+}
+
+}  // namespace sim
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partitionLabel) {
+    (void)partitionLabel;
+    space = name;
+    this->readOnly = readOnly;
+    opened = true;
+    return true;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+    if (!opened || readOnly) return 0;
+    std::lock_guard<std::mutex> guard(storeLock);
+    load();
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    entries[fullKey(key)].assign(bytes, bytes + length);
+    stats.writes++;
+    stats.bytesWritten += length;
+    spaceStats[space].writes++;
+    spaceStats[space].bytesWritten += length;
+    save();
+    return length;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLength) {
+    if (!opened) return 0;
+    std::lock_guard<std::mutex> guard(storeLock);
+    load();
+    const auto entry = entries.find(fullKey(key));
+    if (entry == entries.end() || entry->second.size() > maxLength) return 0;
+    memcpy(buffer, entry->second.data(), entry->second.size());
+    return entry->second.size();
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (!opened) return 0;
+    std::lock_guard<std::mutex> guard(storeLock);
+    load();
+    const auto entry = entries.find(fullKey(key));
+    return entry == entries.end() ? 0 : entry->second.size();
+}
+
+String Preferences::getString(const char* key, const String& defaultValue) {
+    const size_t length = getBytesLength(key);
+    if (length == 0) return defaultValue;
+    std::vector<char> text(length);
+    getBytes(key, text.data(), length);
+    return String(text.data());
+}
+
+bool Preferences::remove(const char* key) {
+    if (!opened || readOnly) return false;
+    std::lock_guard<std::mutex> guard(storeLock);
+    load();
+    const bool removed = entries.erase(fullKey(key)) > 0;
+    if (removed) save();
+    return removed;
+}
+
+bool Preferences::clear() {
+    if (!opened || readOnly) return false;
+    std::lock_guard<std::mutex> guard(storeLock);
+    load();
+    for (auto entry = entries.begin(); entry != entries.end();) {
+        entry = entry->first.compare(0, space.size() + 1, space + "/") == 0 ? entries.erase(entry) : std::next(entry);
+    }
+    save();
+    return true;
+}
@@ -0,0 +1,523 @@
+// Host entry point: runs the unmodified firmware (setup()/loop() from
+// src/main.cpp) against simulated inputs, OLED and WLED node, then prints
+// what each side observed.
+//
+//   .pio/build/native/program [scenario...] [--verbose] [--dump]
+//
+// Scenarios: sweep, buttons, slow-wled, remote, persist, wifi-drop, catalog, acceleration,
+// color-modes, transitions, spsc-stress (default: all)
+//
+// With SIM_NVS=<file> the saved state survives the run; the next run
+// reports what it restored and pushed to WLED at boot.
+
+#include <Arduino.h>
+#include <Sim.h>
+#include "../../src/config.h"
+#include "../../src/SpscRing.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+void setup();
+void loop();
+
+namespace {
+
+std::atomic<bool> running(true);
+
+void loopTask() {
+    while (running) {
+        loop();
+        yield();
+    }
+}
+
+// Waits until the stand-in has been quiet for settleMs, i.e. the firmware
+// has sent everything it is going to send for the last input
+unsigned long waitForWledIdle(unsigned long settleMs, unsigned long timeoutMs) {
+    const unsigned long start = millis();
+    uint32_t lastCount = sim::wledStats().requests;
+    unsigned long lastChange = millis();
+    while (millis() - start < timeoutMs) {
+        delay(10);
+        const uint32_t count = sim::wledStats().requests;
+        if (count != lastCount) {
+            lastCount = count;
+            lastChange = millis();
+        } else if (millis() - lastChange >= settleMs) {
+            break;
+        }
+    }
+    return sim::wledStats().lastRequestMs;
+}
+
+struct Snapshot {
+    sim::WledStats wled;
+    sim::OledStats oled;
+};
+
+Snapshot take() {
+    return Snapshot{sim::wledStats(), sim::oledStats()};
+}
+
+bool report(const char* name, const Snapshot& before, unsigned long inputEndMs,
+            unsigned long lastRequestMs, const char* expected) {
+    const Snapshot after = take();
+    const bool ok = after.wled.lastBody.find(expected) != std::string::npos;
+    printf("\n== %s ==\n", name);
+    printf("  WLED requests:     %u (connections opened: %u)\n",
+           after.wled.requests - before.wled.requests,
+           after.wled.connections - before.wled.connections);
+    printf("  Realtime frames:   %u\n", after.wled.realtimeFrames - before.wled.realtimeFrames);
+    printf("  OLED I2C bytes:    %u in %u transactions\n",
+           after.oled.bytes - before.oled.bytes,
+           after.oled.transactions - before.oled.transactions);
+    printf("  Last request:      %+ld ms from the end of the input\n",
+           static_cast<long>(lastRequestMs - inputEndMs));
+    printf("  Last body:         %s\n", after.wled.lastBody.c_str());
+    printf("  Expected:          %s ... %s\n", expected, ok ? "ok" : "MISSING");
+    return ok;
+}
+
+// A number from a JSON body (the first "key" in it), -1 if it is missing
+long jsonNumber(const std::string& body, const char* key) {
+    const std::string pattern = std::string("\"") + key + "\":";
+    const size_t at = body.find(pattern);
+    if (at == std::string::npos) return -1;
+    return strtol(body.c_str() + at + pattern.size(), nullptr, 10);
+}
+
+long metricCount(const char* key) {
+    return jsonNumber(sim::webRequest("/api/metrics").body, key);
+}
+
+bool sweep() {
+    const Snapshot before = take();
+    // 10 detents at 2 ms per edge: a brisk 80 ms spin covers the whole range
+    sim::turnEncoder(Pins::RED_A, Pins::RED_B, 10, 2000);
+    const unsigned long inputEnd = millis();
+    return report("sweep", before, inputEnd, waitForWledIdle(500, 5000), "\"col\":[[255,0,0]]");
+}
+
+// Buttons::PRESET_VALUE (150) through the 2.2 gamma table of the RGB mode
+constexpr int PRESET_OUTPUT = 79;
+
+bool buttons() {
+    // Bouncy presses: the green preset, then the effect reset
+    Snapshot before = take();
+    sim::pressButton(Pins::GREEN_BUTTON, 80, 6, 150);
+    unsigned long inputEnd = millis();
+    char expected[32];
+    snprintf(expected, sizeof(expected), "\"col\":[[0,%d,0]]", PRESET_OUTPUT);
+    bool ok = report("green button", before, inputEnd, waitForWledIdle(500, 5000), expected);
+
+    before = take();
+    sim::pressButton(Pins::EFFECT_BUTTON, 80, 6, 150);
+    inputEnd = millis();
+    ok &= report("effect button", before, inputEnd, waitForWledIdle(500, 5000), "\"fx\":0");
+
+    // Held past LONG_PRESS_MS: still one preset, then a long press and repeats
+    const long longBefore = metricCount("long_presses");
+    const long repeatsBefore = metricCount("repeats");
+    before = take();
+    sim::pressButton(Pins::RED_BUTTON, 1000, 6, 150);
+    inputEnd = millis();
+    snprintf(expected, sizeof(expected), "\"col\":[[%d,", PRESET_OUTPUT);
+    ok &= report("red button held 1 s", before, inputEnd, waitForWledIdle(500, 5000), expected);
+    const long longPresses = metricCount("long_presses") - longBefore;
+    const long repeats = metricCount("repeats") - repeatsBefore;
+    const bool held = longPresses == 1 && repeats >= 1;
+    printf("  Hold events:       %ld long press, %ld repeats ... %s\n",
+           longPresses, repeats, held ? "ok" : "WRONG");
+    return ok && held;
+}
+
+bool slowWled() {
+    sim::setWledDelayMs(120);
+    const Snapshot before = take();
+    sim::turnEncoder(Pins::BLUE_A, Pins::BLUE_B, 10, 2000);
+    const unsigned long inputEnd = millis();
+    const bool ok = report("slow-wled (120 ms per request)", before, inputEnd,
+                           waitForWledIdle(1000, 10000), ",255]]");
+    sim::setWledDelayMs(0);
+    return ok;
+}
+
+// A change made in the WLED app must reach the knobs without being sent
+// back, and the next knob turn must build on it
+bool remote() {
+    const Snapshot before = take();
+    sim::setWledState(10, 20, 30, 3, 200);
+    delay(Timing::WLED_SYNC_HOLDOFF + 500);
+    const sim::WebResponse status = sim::webRequest("/api/status");
+    const uint32_t echoed = sim::wledStats().requests - before.wled.requests;
+    const bool followed = status.body.find("\"red\":10,\"green\":20,\"blue\":30") != std::string::npos &&
+                          status.body.find("\"effect_index\":3") != std::string::npos;
+    printf("\n== remote change from the WLED app ==\n");
+    printf("  /ws subscribers:   %u, pushes: %u\n", sim::wledStats().subscribers, sim::wledStats().pushes);
+    printf("  Knobs now:         %s ... %s\n", status.body.c_str(), followed ? "ok" : "NOT FOLLOWED");
+    printf("  Requests echoed:   %u ... %s\n", echoed, echoed == 0 ? "ok" : "ECHO");
+
+    const Snapshot turned = take();
+    // Slowly, +1 per detent: red's knob goes from 58 (gamma 10) to 60 (gamma 11);
+    // green and blue keep WLED's levels exactly
+    sim::turnEncoder(Pins::RED_A, Pins::RED_B, 2, 50000);
+    const unsigned long inputEnd = millis();
+    return report("turn after remote change", turned, inputEnd, waitForWledIdle(500, 5000),
+                  "\"bri\":200,\"seg\":[{\"col\":[[11,20,30]]}]") && followed && echoed == 0;
+}
+
+// Several turns with short pauses must end up as one flash write, made
+// only after the knobs have been left alone
+bool persist() {
+    // The effect catalog caches itself in its own namespace; only state saves count here
+    const sim::NvsStats before = sim::nvsStats(Storage::NAMESPACE);
+    for (int turn = 0; turn < 3; turn++) {
+        sim::turnEncoder(Pins::GREEN_A, Pins::GREEN_B, -1, 2000);
+        delay(Storage::SAVE_IDLE / 3);
+    }
+    const uint32_t early = sim::nvsStats(Storage::NAMESPACE).writes - before.writes;
+    delay(Storage::SAVE_IDLE + 2 * Storage::CHECK_INTERVAL);
+    const uint32_t writes = sim::nvsStats(Storage::NAMESPACE).writes - before.writes;
+    printf("\n== persist ==\n");
+    printf("  Flash writes:      %u while turning, %u after the idle period ... %s\n",
+           early, writes, early == 0 && writes == 1 ? "ok" : "UNEXPECTED");
+    return early == 0 && writes == 1;
+}
+
+// Knob turned while the access point is gone: nothing can be sent, but
+// once the firmware has reconnected by itself WLED must get the new state
+bool wifiDrop() {
+    sim::setWifiAvailable(false);
+    delay(100);
+    const Snapshot before = take();
+    sim::turnEncoder(Pins::BLUE_A, Pins::BLUE_B, 2, 2000);
+    delay(1500);
+    const uint32_t sentWhileDown = sim::wledStats().requests - before.wled.requests;
+
+    sim::setWifiAvailable(true);
+    const unsigned long linkBack = millis();
+    const unsigned long lastRequest = waitForWledIdle(500, 15000);
+
+    // Whatever the knobs show now is what WLED must have been sent
+    int red = -1, green = -1, blue = -1;
+    const std::string status = sim::webRequest("/api/status").body;
+    sscanf(status.c_str(), "{\"red\":%d,\"green\":%d,\"blue\":%d", &red, &green, &blue);
+    char expected[48];
+    snprintf(expected, sizeof(expected), "\"col\":[[%d,%d,%d]]", red, green, blue);
+    const bool ok = report("wifi-drop (1.6 s outage)", before, linkBack, lastRequest, expected);
+    printf("  While down:        %u requests reached WLED\n", sentWhileDown);
+    return ok && sentWhileDown == 0;
+}
+
+// The effect knob must reach the node's own effects, skip its reserved
+// IDs, and a node that was not upgraded must not be downloaded again
+bool catalog() {
+    std::string metrics;
+    const unsigned long start = millis();
+    while (millis() - start < 5000) {
+        metrics = sim::webRequest("/api/metrics").body;
+        if (sim::wledStats().infoRequests > 0 && metrics.find("\"source\":\"built-in\"") == std::string::npos) break;
+        delay(50);
+    }
+    const uint32_t downloads = sim::wledStats().catalogRequests;
+    const bool fetched = metrics.find("\"source\":\"wled\"") != std::string::npos;
+    const bool cached = metrics.find("\"source\":\"flash\"") != std::string::npos;
+    const bool complete = metrics.find("\"effects\":118,\"palettes\":71") != std::string::npos;
+
+    // Blink chosen in the app; a detent (four steps) back wraps past effect 0
+    sim::setWledState(0, 0, 0, 1, 255);
+    delay(Timing::WLED_SYNC_HOLDOFF + 500);
+    Snapshot before = take();
+    sim::turnEncoder(Pins::EFFECT_A, Pins::EFFECT_B, -4, 2000);
+    unsigned long inputEnd = millis();
+    bool ok = report("catalog (effect 1, four detents back)", before, inputEnd,
+                     waitForWledIdle(500, 5000), "\"fx\":115");
+    const std::string status = sim::webRequest("/api/status").body;
+    const bool named = status.find("\"effect\":\"Blends\"") != std::string::npos;
+    printf("  Catalog:           %s, %u list downloads, 118 effects / 71 palettes ... %s\n",
+           fetched ? "fetched" : cached ? "from flash" : "built-in", downloads,
+           complete && ((fetched && downloads == 2) || (cached && downloads == 0)) ? "ok" : "UNEXPECTED");
+    printf("  Knobs now:         %s ... %s\n", status.c_str(), named ? "ok" : "UNNAMED");
+
+    // Tri Wipe chosen in the app; going back passes over reserved ID 53
+    sim::setWledState(0, 0, 0, 55, 255);
+    delay(Timing::WLED_SYNC_HOLDOFF + 500);
+    before = take();
+    sim::turnEncoder(Pins::EFFECT_A, Pins::EFFECT_B, -4, 2000);
+    inputEnd = millis();
+    ok &= report("catalog (effect 55, four detents back)", before, inputEnd,
+                 waitForWledIdle(500, 5000), "\"fx\":50");
+    return ok && named && complete && ((fetched && downloads == 2) || (cached && downloads == 0));
+}
+
+// Detent timings recorded from a real knob: a fine adjustment, a flick
+// across the range, then a slow correction. Slow detents must move the knob
+// position by 1; the flick must reach the top of the range before it ends.
+bool acceleration() {
+    struct Detent {
+        int direction;
+        unsigned long intervalMs;   // Since the previous detent
+    };
+    static const Detent fine[] = {{1, 400}, {1, 260}, {1, 180}};
+    static const Detent flick[] = {{1, 70}, {1, 35}, {1, 18}, {1, 11}, {1, 9},
+                                   {1, 9}, {1, 8}, {1, 8}, {1, 9}, {1, 12}};
+    static const Detent correction[] = {{-1, 600}, {-1, 300}};
+    // Each detent is four edges; its last edge lands intervalMs after the previous detent's
+    auto play = [](const Detent& detent) {
+        sim::turnEncoder(Pins::RED_A, Pins::RED_B, detent.direction, detent.intervalMs * 1000 / 4);
+    };
+
+    sim::setWledState(0, 0, 0, 0, 255);
+    delay(Timing::WLED_SYNC_HOLDOFF + 500);
+    const Snapshot before = take();
+
+    for (const Detent& detent : fine) play(detent);
+    delay(100);
+    const std::string afterFine = sim::webRequest("/api/status").body;
+    const bool fineOk = afterFine.find("\"knobs\":[3,") != std::string::npos;
+
+    for (const Detent& detent : flick) play(detent);
+    delay(100);
+    const std::string afterFlick = sim::webRequest("/api/status").body;
+    const bool flickOk = afterFlick.find("\"knobs\":[255,") != std::string::npos;
+    for (const Detent& detent : correction) play(detent);
+    const unsigned long inputEnd = millis();
+
+    const bool ok = report("acceleration (recorded detent timings)", before, inputEnd,
+                           waitForWledIdle(500, 5000), "\"col\":[[251,0,0]]");  // Knob 253, gamma-corrected
+    printf("  Fine, 3 detents:   %s ... %s\n", afterFine.c_str(), fineOk ? "ok" : "NOT 3");
+    printf("  Flick, %zu detents: %s ... %s\n", sizeof(flick) / sizeof(flick[0]), afterFlick.c_str(),
+           flickOk ? "ok" : "NOT 255");
+    return ok && fineOk && flickOk;
+}
+
+// Holding the effect button steps the color mode without resetting the
+// effect; presets and knobs then act in that mode
+bool colorModes() {
+    sim::setWledState(0, 0, 0, 3, 255);
+    delay(Timing::WLED_SYNC_HOLDOFF + 500);
+    auto holdEffectButton = [](const char* mode) {
+        sim::pressButton(Pins::EFFECT_BUTTON, 1000, 6, 150);
+        delay(100);
+        const std::string status = sim::webRequest("/api/status").body;
+        const bool ok = status.find(std::string("\"mode\":\"") + mode + "\"") != std::string::npos &&
+                        status.find("\"effect_index\":3,") != std::string::npos;
+        printf("  Effect button held: %s ... %s\n", status.c_str(), ok ? "ok" : "WRONG");
+        return ok;
+    };
+
+    printf("\n== color-modes ==\n");
+    bool ok = holdEffectButton("hsv");
+    Snapshot before = take();
+    sim::pressButton(Pins::BLUE_BUTTON, 80, 6, 150);
+    unsigned long inputEnd = millis();
+    ok &= report("color-modes: HSV blue preset (hue 170, value 150)", before, inputEnd,
+                 waitForWledIdle(500, 5000), "\"col\":[[0,1,79]]");
+
+    // Saturation 255 -> 222 (a slow detent, then a fast one): red and green rise toward blue
+    before = take();
+    sim::turnEncoder(Pins::GREEN_A, Pins::GREEN_B, -2, 2000);
+    inputEnd = millis();
+    ok &= report("color-modes: HSV saturation down", before, inputEnd,
+                 waitForWledIdle(500, 5000), "\"col\":[[10,11,79]]");
+
+    ok &= holdEffectButton("temperature");
+    before = take();
+    sim::pressButton(Pins::GREEN_BUTTON, 80, 6, 150);
+    inputEnd = millis();
+    ok &= report("color-modes: temperature green preset (~4000 K, level 150)", before, inputEnd,
+                 waitForWledIdle(500, 5000), "\"col\":[[79,65,50]]");
+
+    // The third knob has no job in temperature mode: turning it changes nothing
+    before = take();
+    sim::turnEncoder(Pins::BLUE_A, Pins::BLUE_B, 3, 2000);
+    delay(300);
+    const std::string unused = sim::webRequest("/api/status").body;
+    const uint32_t sent = sim::wledStats().requests - before.wled.requests;
+    const bool ignored = unused.find("\"knobs\":[") != std::string::npos &&
+                         unused.find(",0]}") != std::string::npos && sent == 0;
+    printf("  Unused knob turned: %s, %u requests ... %s\n", unused.c_str(), sent, ignored ? "ok" : "WRONG");
+    ok &= ignored;
+
+    ok &= holdEffectButton("rgb");
+    return ok;
+}
+
+// A steady turn against a node slow enough to pace requests ~200 ms apart
+// must become a sweep: after the first few exact colors, requests carry
+// predicted colors with a transition, still at the node's pace, and the
+// last lands on the knob's exact color
+bool transitions() {
+    constexpr unsigned long DELAY_MS = 100;
+    sim::setWledDelayMs(DELAY_MS);
+    sim::setWledState(0, 0, 0, 0, 255);
+    delay(Timing::WLED_SYNC_HOLDOFF + 500);
+    // Let the pacer's round-trip average settle on the slow node first,
+    // with back-and-forth detents that never look like a sweep
+    for (int i = 0; i < 32; i++) {
+        sim::turnEncoder(Pins::RED_A, Pins::RED_B, i % 2 == 0 ? 1 : -1, 2000);
+        delay(250);
+    }
+    waitForWledIdle(1000, 5000);
+    const long sweepsBefore = metricCount("sweeps");
+    const Snapshot before = take();
+
+    // 70 ms apart: acceleration ramps the step up, then holds it, short of the top
+    constexpr int DETENTS = 30;
+    const unsigned long inputStart = millis();
+    sim::turnEncoder(Pins::BLUE_A, Pins::BLUE_B, DETENTS, 17500);
+    const unsigned long inputEnd = millis();
+    const unsigned long lastRequest = waitForWledIdle(1000, 5000);
+
+    const std::string status = sim::webRequest("/api/status").body;
+    char expected[48];
+    snprintf(expected, sizeof(expected), "\"col\":[[%ld,%ld,%ld]]", jsonNumber(status, "red"),
+             jsonNumber(status, "green"), jsonNumber(status, "blue"));
+    const bool ok = report("transitions (2.1 s steady turn)", before, inputEnd, lastRequest, expected);
+    sim::setWledDelayMs(0);
+
+    const Snapshot after = take();
+    const uint32_t requests = after.wled.requests - before.wled.requests;
+    const uint32_t faded = after.wled.transitions - before.wled.transitions;
+    // No more than the pace allows: input time over ~2 round trips, plus the
+    // immediate first request, the last input and the settling one
+    const uint32_t budget = (inputEnd - inputStart + 2 * DELAY_MS - 1) / (2 * DELAY_MS) + 3;
+    const long sweeps = metricCount("sweeps") - sweepsBefore;
+    // Host scheduling makes the detents uneven enough to split a sweep
+    // now and then, so only ask for one that faded a few requests
+    const bool paced = requests <= budget && faded >= Timing::WLED_SWEEP_SAMPLES && sweeps >= 1;
+    printf("  Sweep:             %u requests (at most %u), %u with transitions, %ld sweeps ... %s\n",
+           requests, budget, faded, sweeps, paced ? "ok" : "WRONG");
+    return ok && paced;
+}
+
+// A producer and a consumer thread hammer one ring: every item must arrive
+// exactly once and in order, and each push refused because the ring was
+// full must be counted as an overflow
+bool spscStress() {
+    constexpr uint32_t ITEMS = 1000000;
+    static SpscRing<uint32_t, 64> ring;
+
+    printf("\n== spsc-stress ==\n");
+    uint32_t refused = 0;
+    std::thread producer([&refused] {
+        for (uint32_t sequence = 0; sequence < ITEMS; ) {
+            if (ring.push(sequence)) {
+                sequence++;
+            } else {
+                refused++;
+                std::this_thread::yield();  // Let the consumer catch up rather than spin
+            }
+        }
+    });
+    uint32_t expected = 0;
+    uint32_t outOfOrder = 0;
+    while (expected < ITEMS) {
+        uint32_t item;
+        if (!ring.pop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (item != expected) outOfOrder++;
+        expected = item + 1;  // Resynchronize so one fault is counted once
+    }
+    producer.join();
+    uint32_t extra;
+    const bool drained = !ring.pop(extra) && ring.size() == 0;
+    const bool threadsOk = outOfOrder == 0 && drained && ring.getOverflows() == refused;
+    printf("  Two threads:       %u items, %u out of sequence, %u overflows for %u refused pushes ... %s\n",
+           ITEMS, outOfOrder, ring.getOverflows(), refused, threadsOk ? "ok" : "WRONG");
+
+    // Filled with nobody consuming: exactly the extra pushes overflow, and
+    // the ring still hands back what it accepted, in order
+    static SpscRing<uint32_t, 64> full;
+    constexpr uint32_t EXTRA = 10;
+    uint32_t accepted = 0;
+    for (uint32_t sequence = 0; sequence < full.capacity() + EXTRA; sequence++) {
+        if (full.push(sequence)) accepted++;
+    }
+    bool inOrder = true;
+    for (uint32_t sequence = 0; sequence < accepted; sequence++) {
+        uint32_t item = 0;
+        inOrder &= full.pop(item) && item == sequence;
+    }
+    const bool fullOk = accepted == full.capacity() && full.getOverflows() == EXTRA && inOrder &&
+                        full.size() == 0;
+    printf("  Full ring:         %u of %zu accepted, %u overflows ... %s\n",
+           accepted, full.capacity() + EXTRA, full.getOverflows(), fullOk ? "ok" : "WRONG");
+    return threadsOk && fullOk;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    bool verbose = false;
+    bool dump = false;
+    std::vector<std::string> scenarios;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--verbose") verbose = true;
+        else if (arg == "--dump") dump = true;
+        else scenarios.push_back(arg);
+    }
+    if (scenarios.empty()) scenarios = {"sweep", "buttons", "slow-wled", "remote", "persist", "wifi-drop", "catalog",
+                                          "acceleration", "color-modes", "transitions", "spsc-stress"};
+
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+    sim::setSerialEnabled(verbose);
+    sim::startWledStandIn();
+
+    const bool hadSavedState = sim::nvsStats().keys > 0;
+    const unsigned long bootStart = millis();
+    setup();
+    printf("setup() returned after %lu ms\n", millis() - bootStart);
+    const int stream = sim::openEventStream("/api/events");
+    std::thread(loopTask).detach();
+    waitForWledIdle(300, 3000);  // Boot traffic
+    if (hadSavedState) printf("Restored at boot, pushed to WLED: %s\n", sim::wledStats().lastBody.c_str());
+
+    bool ok = true;
+    for (const std::string& scenario : scenarios) {
+        if (scenario == "sweep") ok &= sweep();
+        else if (scenario == "buttons") ok &= buttons();
+        else if (scenario == "slow-wled") ok &= slowWled();
+        else if (scenario == "remote") ok &= remote();
+        else if (scenario == "persist") ok &= persist();
+        else if (scenario == "wifi-drop") ok &= wifiDrop();
+        else if (scenario == "catalog") ok &= catalog();
+        else if (scenario == "acceleration") ok &= acceleration();
+        else if (scenario == "color-modes") ok &= colorModes();
+        else if (scenario == "transitions") ok &= transitions();
+        else if (scenario == "spsc-stress") ok &= spscStress();
+        else {
+            fprintf(stderr, "unknown scenario: %s\n", scenario.c_str());
+            ok = false;
+        }
+    }
+
+    sim::WebResponse status = sim::webRequest("/api/status");
+    printf("\n/api/status -> %d %s ETag %s\n", status.code, status.body.c_str(),
+           status.headers["ETag"].c_str());
+    const sim::WebResponse revalidated = sim::webRequest("/api/status", {{"If-None-Match", status.headers["ETag"]}});
+    printf("/api/status If-None-Match -> %d\n", revalidated.code);
+    if (revalidated.code != 304) ok = false;
+    const sim::EventStream events = sim::eventStream(stream);
+    size_t eventBytes = 0;
+    for (const std::string& message : events.messages) eventBytes += message.size();
+    printf("/api/events -> %zu messages, %zu bytes%s%s\n", events.messages.size(), eventBytes,
+           events.messages.empty() ? "" : ", last ", events.messages.empty() ? "" : events.messages.back().c_str());
+    const sim::WebResponse metrics = sim::webRequest("/api/metrics");
+    printf("/api/metrics -> %d %s\n", metrics.code, metrics.body.c_str());
+    if (dump) {
+        printf("\nOLED:\n");
+        sim::oledDump(stdout);
+    }
+
+    running = false;
+    fflush(stdout);
+    _exit(ok ? 0 : 1);  // Firmware tasks never return; skip static destructors
+}
@@ -0,0 +1,160 @@
+#include <ESPAsyncWebServer.h>
+#include <Sim.h>
+
+#include <algorithm>
+#include <mutex>
+
+namespace {
+
+struct Route {
+    std::string path;
+    ArRequestHandlerFunction handler;
+};
+
+std::mutex routesLock;
+std::vector<Route> routes;
+
+// Event sources are registered from firmware globals' constructors, which
+// may run before this file's statics are initialised
+std::vector<AsyncEventSource*>& eventSources() {
+    static std::vector<AsyncEventSource*> sources;
+    return sources;
+}
+std::vector<AsyncEventSourceClient*> eventClients;  // Index is the id given to scenarios
+
+}  // namespace
+
+void AsyncWebServer::on(const char* uri, WebRequestMethod method, ArRequestHandlerFunction handler) {
+    (void)method;
+    std::lock_guard<std::mutex> guard(routesLock);
+    routes.push_back(Route{uri, handler});
+}
+
+bool AsyncWebServerRequest::hasHeader(const char* name) const {
+    return getHeader(name) != nullptr;
+}
+
+AsyncWebHeader* AsyncWebServerRequest::getHeader(const char* name) const {
+    for (AsyncWebHeader* header : requestHeaders) {
+        if (strcasecmp(header->name().c_str(), name) == 0) return header;
+    }
+    return nullptr;
+}
+
+void AsyncWebServerRequest::addRequestHeader(const String& name, const String& value) {
+    requestHeaders.push_back(new AsyncWebHeader(name, value));
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const String& contentType,
+                                                             const String& content) {
+    return new AsyncWebServerResponse(code, contentType, content);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse_P(int code, const String& contentType,
+                                                               const uint8_t* content, size_t length) {
+    return new AsyncWebServerResponse(code, contentType,
+        String(std::string(reinterpret_cast<const char*>(content), length)));
+}
+
+void AsyncWebServerRequest::send(AsyncWebServerResponse* newResponse) {
+    delete response;
+    response = newResponse;
+}
+
+void AsyncWebServerRequest::send(int code, const String& contentType, const String& content) {
+    send(beginResponse(code, contentType, content));
+}
+
+void AsyncEventSourceClient::send(const char* message, const char* event, uint32_t id, uint32_t reconnect) {
+    (void)reconnect;
+    if (!open) return;
+    std::lock_guard<std::mutex> guard(routesLock);
+    received.push_back(std::string(event ? event : "message") + ": " + message);
+    if (id) lastEventId = id;
+}
+
+AsyncEventSource::AsyncEventSource(const String& url) : path(url) {
+    std::lock_guard<std::mutex> guard(routesLock);
+    eventSources().push_back(this);
+}
+
+AsyncEventSource::~AsyncEventSource() {
+    std::lock_guard<std::mutex> guard(routesLock);
+    auto& sources = eventSources();
+    sources.erase(std::remove(sources.begin(), sources.end(), this), sources.end());
+}
+
+void AsyncEventSource::send(const char* message, const char* event, uint32_t id, uint32_t reconnect) {
+    std::vector<AsyncEventSourceClient*> targets;
+    {
+        std::lock_guard<std::mutex> guard(routesLock);
+        targets = clients;
+    }
+    for (AsyncEventSourceClient* client : targets) client->send(message, event, id, reconnect);
+}
+
+size_t AsyncEventSource::count() const {
+    std::lock_guard<std::mutex> guard(routesLock);
+    return std::count_if(clients.begin(), clients.end(),
+                         [](AsyncEventSourceClient* client) { return client->connected(); });
+}
+
+void AsyncEventSource::close() {
+    std::lock_guard<std::mutex> guard(routesLock);
+    for (AsyncEventSourceClient* client : clients) client->close();
+}
+
+AsyncEventSourceClient* AsyncEventSource::connect() {
+    AsyncEventSourceClient* client = new AsyncEventSourceClient();
+    {
+        std::lock_guard<std::mutex> guard(routesLock);
+        clients.push_back(client);
+    }
+    if (connectHandler) connectHandler(client);  // Runs on the caller's thread, like the async TCP task
+    return client;
+}
+
+namespace sim {
+
+int openEventStream(const char* path) {
+    AsyncEventSource* source = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(routesLock);
+        for (AsyncEventSource* candidate : eventSources()) {
+            if (candidate->url() == path) source = candidate;
+        }
+    }
+    if (source == nullptr) return -1;
+    AsyncEventSourceClient* client = source->connect();
+    std::lock_guard<std::mutex> guard(routesLock);
+    eventClients.push_back(client);
+    return static_cast<int>(eventClients.size() - 1);
+}
+
+EventStream eventStream(int id) {
+    std::lock_guard<std::mutex> guard(routesLock);
+    if (id < 0 || id >= static_cast<int>(eventClients.size())) return EventStream{false, {}};
+    return EventStream{eventClients[id]->connected(), eventClients[id]->received};
+}
+
+WebResponse webRequest(const char* path, const std::vector<std::pair<std::string, std::string>>& headers) {
+    ArRequestHandlerFunction handler;
+    {
+        std::lock_guard<std::mutex> guard(routesLock);
+        for (const Route& route : routes) {
+            if (route.path == path) handler = route.handler;
+        }
+    }
+    if (!handler) return WebResponse{404, "text/plain", "Not found", {}};
+
+    AsyncWebServerRequest request{String(path)};
+    for (const auto& header : headers) request.addRequestHeader(header.first, header.second);
+    handler(&request);
+    if (request.response == nullptr) return WebResponse{500, "text/plain", "No response", {}};
+
+    WebResponse result{request.response->code, request.response->contentType, request.response->content, {}};
+    for (const auto& header : request.response->headers) result.headers[header.first] = header.second;
+    return result;
+}
+
+}  // namespace sim
@@ -0,0 +1,144 @@
+#include <WebSocketsClient.h>
+
+// Client half of RFC 6455 as far as WLED's /ws needs it: one handshake,
+// unfragmented text frames, close, and ping/pong.
+
+namespace {
+
+constexpr uint8_t OPCODE_TEXT = 0x1;
+constexpr uint8_t OPCODE_CLOSE = 0x8;
+constexpr uint8_t OPCODE_PING = 0x9;
+constexpr uint8_t OPCODE_PONG = 0xA;
+
+// Client frames must be masked; the key does not matter to the stand-in
+void sendFrame(WiFiClient& client, uint8_t opcode, const uint8_t* payload, size_t length) {
+    std::string frame;
+    frame += static_cast<char>(0x80 | opcode);
+    if (length < 126) {
+        frame += static_cast<char>(0x80 | length);
+    } else {
+        frame += static_cast<char>(0x80 | 126);
+        frame += static_cast<char>(length >> 8);
+        frame += static_cast<char>(length & 0xFF);
+    }
+    const uint8_t mask[4] = {0x12, 0x34, 0x56, 0x78};
+    frame.append(reinterpret_cast<const char*>(mask), 4);
+    for (size_t i = 0; i < length; i++) frame += static_cast<char>(payload[i] ^ mask[i % 4]);
+    client.write(reinterpret_cast<const uint8_t*>(frame.data()), frame.size());
+}
+
+}  // namespace
+
+void WebSocketsClient::begin(const char* host, uint16_t port, const char* url, const char* protocol) {
+    (void)protocol;
+    this->host = host;
+    this->port = port;
+    this->url = url;
+    started = true;
+    attempted = false;
+}
+
+void WebSocketsClient::loop() {
+    if (!started) return;
+    if (!open) {
+        if (attempted && millis() - lastAttemptMs < reconnectIntervalMs) return;
+        attempted = true;
+        lastAttemptMs = millis();
+        if (!client.connect(host.c_str(), port, 1000) || !handshake()) {
+            client.stop();
+            return;
+        }
+        open = true;
+        received.clear();
+        emit(WStype_CONNECTED, reinterpret_cast<uint8_t*>(&url[0]), url.size());
+    }
+
+    if (!client.connected()) {
+        open = false;
+        emit(WStype_DISCONNECTED, nullptr, 0);
+        return;
+    }
+    while (client.available() > 0) {
+        uint8_t chunk[512];
+        const int count = client.read(chunk, sizeof(chunk));
+        if (count <= 0) break;
+        received.append(reinterpret_cast<char*>(chunk), count);
+    }
+    while (open && readFrame()) {}
+}
+
+// Blocking upgrade request; the stand-in answers at once
+bool WebSocketsClient::handshake() {
+    std::string request = "GET " + url + " HTTP/1.1\r\n"
+                          "Host: " + host + "\r\n"
+                          "Upgrade: websocket\r\n"
+                          "Connection: Upgrade\r\n"
+                          "Sec-WebSocket-Key: c2ltdWxhdG9yLWtleS0wMQ==\r\n"
+                          "Sec-WebSocket-Version: 13\r\n\r\n";
+    client.write(reinterpret_cast<const uint8_t*>(request.data()), request.size());
+
+    std::string response;
+    const unsigned long start = millis();
+    while (response.find("\r\n\r\n") == std::string::npos) {
+        if (millis() - start > 1000) return false;
+        const int c = client.read();
+        if (c < 0) {
+            if (!client.connected()) return false;
+            delay(1);
+            continue;
+        }
+        response += static_cast<char>(c);
+    }
+    return response.compare(0, 12, "HTTP/1.1 101") == 0;
+}
+
+// Consumes one complete frame from received; false if none is complete
+bool WebSocketsClient::readFrame() {
+    if (received.size() < 2) return false;
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(received.data());
+    const uint8_t opcode = data[0] & 0x0F;
+    size_t length = data[1] & 0x7F;
+    size_t offset = 2;
+    if (length == 126) {
+        if (received.size() < 4) return false;
+        length = (data[2] << 8) | data[3];
+        offset = 4;
+    } else if (length == 127) {
+        if (received.size() < 10) return false;
+        length = 0;
+        for (int i = 2; i < 10; i++) length = (length << 8) | data[i];
+        offset = 10;
+    }
+    if (received.size() < offset + length) return false;
+
+    std::string payload = received.substr(offset, length);
+    received.erase(0, offset + length);
+    switch (opcode) {
+        case OPCODE_TEXT:
+            emit(WStype_TEXT, reinterpret_cast<uint8_t*>(&payload[0]), payload.size());
+            break;
+        case OPCODE_PING:
+            sendFrame(client, OPCODE_PONG, reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+            break;
+        case OPCODE_CLOSE:
+            disconnect();
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+bool WebSocketsClient::sendTXT(const char* payload) {
+    if (!open) return false;
+    sendFrame(client, OPCODE_TEXT, reinterpret_cast<const uint8_t*>(payload), strlen(payload));
+    return true;
+}
+
+void WebSocketsClient::disconnect() {
+    if (!open) return;
+    sendFrame(client, OPCODE_CLOSE, nullptr, 0);
+    client.stop();
+    open = false;
+    emit(WStype_DISCONNECTED, nullptr, 0);
+}
@@ -0,0 +1,332 @@
+#include <Arduino.h>
+#include <Sim.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Minimal WLED node on loopback: answers every HTTP request with
+// {"success":true} on a keep-alive connection and counts realtime frames.
+// It keeps the color, effect and brightness it was sent and, like WLED,
+// pushes its state to every /ws subscriber whenever that state changes.
+// GET /json/info, /json/eff and /json/pal answer like a WLED 0.14 build.
+
+namespace {
+
+struct NodeState {
+    int red = 0;
+    int green = 0;
+    int blue = 0;
+    int effect = 0;
+    int brightness = 128;
+    bool live = false;
+};
+
+std::mutex statsLock;       // Guards stats, node and subscribers
+sim::WledStats stats = {};
+NodeState node;
+std::vector<int> subscribers;
+std::atomic<unsigned long> responseDelayMs(0);
+
+const char VERSION[] = "0.14.4";
+const unsigned long BUILD = 2405180;
+
+// WLED's effect list up to Dynamic Smooth, reserved IDs included
+const char* const EFFECT_NAMES[] = {
+    "Solid", "Blink", "Breathe", "Wipe", "Wipe Random", "Random Colors", "Sweep", "Dynamic",
+    "Colorloop", "Rainbow", "Scan", "Scan Dual", "Fade", "Theater", "Theater Rainbow", "Running",
+    "Saw", "Twinkle", "Dissolve", "Dissolve Rnd", "Sparkle", "Sparkle Dark", "Sparkle+", "Strobe",
+    "Strobe Rainbow", "Strobe Mega", "Blink Rainbow", "Android", "Chase", "Chase Random",
+    "Chase Rainbow", "Chase Flash", "Chase Flash Rnd", "Rainbow Runner", "Colorful", "Traffic Light",
+    "Sweep Random", "Chase 2", "Aurora", "Stream", "Scanner", "Lighthouse", "Fireworks", "Rain",
+    "Tetrix", "Fire Flicker", "Gradient", "Loading", "Rolling Balls", "Fairy", "Two Dots",
+    "Fairytwinkle", "Running Dual", "RSVD", "Chase 3", "Tri Wipe", "Tri Fade", "Lightning", "ICU",
+    "Multi Comet", "Scanner Dual", "Stream 2", "Oscillate", "Pride 2015", "Juggle", "Palette",
+    "Fire 2012", "Colorwaves", "Bpm", "Fill Noise", "Noise 1", "Noise 2", "Noise 3", "Noise 4",
+    "Colortwinkles", "Lake", "Meteor", "Meteor Smooth", "Railway", "Ripple", "Twinklefox",
+    "Twinklecat", "Halloween Eyes", "Solid Pattern", "Solid Pattern Tri", "Spots", "Spots Fade",
+    "Glitter", "Candle", "Fireworks Starburst", "Fireworks 1D", "Bouncing Balls", "Sinelon",
+    "Sinelon Dual", "Sinelon Rainbow", "Popcorn", "Drip", "Plasma", "Percent", "Ripple Rainbow",
+    "Heartbeat", "Pacifica", "Candle Multi", "Solid Glitter", "Sunrise", "Phased", "Twinkleup",
+    "Noise Pal", "Sine", "Phased Noise", "Flow", "Chunchun", "Dancing Shadows", "Washing Machine",
+    "RSVD", "Blends", "TV Simulator", "Dynamic Smooth"
+};
+
+const char* const PALETTE_NAMES[] = {
+    "Default", "* Random Cycle", "* Color 1", "* Colors 1&2", "* Color Gradient", "* Colors Only",
+    "Party", "Cloud", "Lava", "Ocean", "Forest", "Rainbow", "Rainbow Bands", "Sunset", "Rivendell",
+    "Breeze", "Red & Blue", "Yellowout", "Analogous", "Splash", "Pastel", "Sunset 2", "Beach",
+    "Vintage", "Departure", "Landscape", "Beech", "Sherbet", "Hult", "Hult 64", "Drywet", "Jul",
+    "Grintage", "Rewhi", "Tertiary", "Fire", "Icefire", "Cyane", "Light Pink", "Autumn", "Magenta",
+    "Magred", "Yelmag", "Yelblu", "Orange & Teal", "Tiamat", "April Night", "Orangery", "C9",
+    "Sakura", "Aurora", "Atlantica", "C9 2", "C9 New", "Temperature", "Aurora 2", "Retro Clown",
+    "Candy", "Toxy Reaf", "Fairy Reaf", "Semi Blue", "Pink Candy", "Red Reaf", "Aqua Flash",
+    "Yelblu Hot", "Lite Light", "Red Flash", "Blink Red", "Red Shift", "Red Tide", "Candy2"
+};
+
+template <size_t N>
+std::string nameList(const char* const (&names)[N]) {
+    std::string list = "[";
+    for (size_t i = 0; i < N; i++) {
+        if (i > 0) list += ",";
+        list += std::string("\"") + names[i] + "\"";
+    }
+    return list + "]";
+}
+
+// Bodies of the read-only endpoints, empty for anything else
+std::string getBody(const std::string& path) {
+    if (path == "/json/eff") return nameList(EFFECT_NAMES);
+    if (path == "/json/pal") return nameList(PALETTE_NAMES);
+    if (path == "/json/info") {
+        char text[256];
+        snprintf(text, sizeof(text),
+                 "{\"ver\":\"%s\",\"vid\":%lu,\"leds\":{\"count\":60,\"rgbw\":false},"
+                 "\"name\":\"WLED\",\"fxcount\":%zu,\"palcount\":%zu,\"arch\":\"sim\"}",
+                 VERSION, BUILD, sizeof(EFFECT_NAMES) / sizeof(EFFECT_NAMES[0]),
+                 sizeof(PALETTE_NAMES) / sizeof(PALETTE_NAMES[0]));
+        return text;
+    }
+    return std::string();
+}
+
+// Server frames are unmasked; WLED's pushes fit a 16-bit length
+void sendTextFrame(int fd, const std::string& text) {
+    std::string frame(1, static_cast<char>(0x81));
+    if (text.size() < 126) {
+        frame += static_cast<char>(text.size());
+    } else {
+        frame += static_cast<char>(126);
+        frame += static_cast<char>(text.size() >> 8);
+        frame += static_cast<char>(text.size() & 0xFF);
+    }
+    frame += text;
+    send(fd, frame.data(), frame.size(), MSG_NOSIGNAL);
+}
+
+// Caller holds statsLock
+std::string stateMessage() {
+    char text[256];
+    snprintf(text, sizeof(text),
+             "{\"state\":{\"on\":true,\"bri\":%d,\"transition\":7,\"live\":%s,"
+             "\"seg\":[{\"id\":0,\"col\":[[%d,%d,%d],[0,0,0],[0,0,0]],\"fx\":%d,\"sx\":128}]},"
+             "\"info\":{\"ver\":\"%s\",\"leds\":{\"count\":60}}}",
+             node.brightness, node.live ? "true" : "false", node.red, node.green, node.blue, node.effect,
+             VERSION);
+    return text;
+}
+
+// Caller holds statsLock
+void pushState() {
+    const std::string message = stateMessage();
+    for (int fd : subscribers) sendTextFrame(fd, message);
+    if (!subscribers.empty()) stats.pushes++;
+}
+
+bool findInt(const std::string& body, const char* key, int& value) {
+    const size_t at = body.find(key);
+    if (at == std::string::npos) return false;
+    value = atoi(body.c_str() + at + strlen(key));
+    return true;
+}
+
+// Caller holds statsLock; true if the node state changed
+bool applyBody(const std::string& body) {
+    const NodeState before = node;
+    findInt(body, "\"bri\":", node.brightness);
+    findInt(body, "\"fx\":", node.effect);
+    const size_t color = body.find("\"col\":[[");
+    if (color != std::string::npos) {
+        sscanf(body.c_str() + color, "\"col\":[[%d,%d,%d", &node.red, &node.green, &node.blue);
+    }
+    if (body.find("\"live\":false") != std::string::npos) node.live = false;
+    return before.red != node.red || before.green != node.green || before.blue != node.blue ||
+           before.effect != node.effect || before.brightness != node.brightness || before.live != node.live;
+}
+
+int listenOn(int type, uint16_t port) {
+    int fd = socket(AF_INET, type, 0);
+    const int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port + sim::portOffset());
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        fprintf(stderr, "sim: cannot bind port %u: %s\n", port + sim::portOffset(), strerror(errno));
+        exit(1);
+    }
+    if (type == SOCK_STREAM) listen(fd, 8);
+    return fd;
+}
+
+// Reads one request (headers plus Content-Length body); false when the peer closed.
+// headers comes back lower-cased.
+bool readRequest(int fd, std::string& pending, std::string& headers, std::string& body, bool& keepAlive) {
+    size_t headerEnd;
+    while ((headerEnd = pending.find("\r\n\r\n")) == std::string::npos) {
+        char chunk[512];
+        ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+        if (received <= 0) return false;
+        pending.append(chunk, received);
+    }
+
+    headers = pending.substr(0, headerEnd);
+    std::transform(headers.begin(), headers.end(), headers.begin(), ::tolower);
+    size_t contentLength = 0;
+    size_t field = headers.find("content-length:");
+    if (field != std::string::npos) contentLength = strtoul(headers.c_str() + field + 15, nullptr, 10);
+    keepAlive = headers.find("connection: close") == std::string::npos &&
+                headers.find(" http/1.0") == std::string::npos;
+
+    const size_t requestEnd = headerEnd + 4 + contentLength;
+    while (pending.size() < requestEnd) {
+        char chunk[512];
+        ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+        if (received <= 0) return false;
+        pending.append(chunk, received);
+    }
+    body = pending.substr(headerEnd + 4, contentLength);
+    pending.erase(0, requestEnd);
+    return true;
+}
+
+// After the upgrade the node only talks; client frames are read and
+// dropped until the client closes
+void serveWebSocket(int fd) {
+    static const char reply[] =
+        "HTTP/1.1 101 Switching Protocols\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: c2ltdWxhdG9yLWFjY2VwdA==\r\n"  // The shim does not check it
+        "\r\n";
+    {
+        std::lock_guard<std::mutex> guard(statsLock);
+        send(fd, reply, sizeof(reply) - 1, MSG_NOSIGNAL);
+        sendTextFrame(fd, stateMessage());  // WLED greets a new client with its state
+        subscribers.push_back(fd);
+        stats.subscribers++;
+    }
+
+    uint8_t frame[512];
+    while (recv(fd, frame, sizeof(frame), 0) > 0) {
+        if ((frame[0] & 0x0F) == 0x8) break;  // Close
+    }
+
+    std::lock_guard<std::mutex> guard(statsLock);
+    subscribers.erase(std::remove(subscribers.begin(), subscribers.end(), fd), subscribers.end());
+    stats.subscribers--;
+    close(fd);
+}
+
+void serveConnection(int fd) {
+    std::string pending;
+    std::string headers;
+    std::string body;
+    bool keepAlive = true;
+    while (keepAlive && readRequest(fd, pending, headers, body, keepAlive)) {
+        if (headers.find("upgrade: websocket") != std::string::npos) {
+            serveWebSocket(fd);
+            return;
+        }
+        if (responseDelayMs) delay(responseDelayMs);
+
+        if (headers.rfind("get ", 0) == 0) {
+            const std::string path = headers.substr(4, headers.find(' ', 4) - 4);
+            const std::string reply = getBody(path);
+            {
+                std::lock_guard<std::mutex> guard(statsLock);
+                if (path == "/json/info") stats.infoRequests++;
+                else stats.catalogRequests++;
+            }
+            char head[160];
+            snprintf(head, sizeof(head),
+                     "HTTP/1.1 %s\r\nContent-Type: application/json\r\nContent-Length: %zu\r\n%s\r\n",
+                     reply.empty() ? "404 Not Found" : "200 OK", reply.size(),
+                     keepAlive ? "" : "Connection: close\r\n");
+            send(fd, head, strlen(head), MSG_NOSIGNAL);
+            send(fd, reply.data(), reply.size(), MSG_NOSIGNAL);
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> guard(statsLock);
+            stats.requests++;
+            if (body.find("\"tt\":") != std::string::npos) stats.transitions++;
+            stats.lastRequestMs = millis();
+            stats.lastBody = body;
+            if (applyBody(body)) pushState();
+        }
+        static const char reply[] =
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: application/json\r\n"
+            "Content-Length: 16\r\n"
+            "\r\n"
+            "{\"success\":true}";
+        send(fd, reply, sizeof(reply) - 1, MSG_NOSIGNAL);
+    }
+    close(fd);
+}
+
+void serveHttp(int listener) {
+    for (;;) {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) continue;
+        {
+            std::lock_guard<std::mutex> guard(statsLock);
+            stats.connections++;
+        }
+        std::thread(serveConnection, fd).detach();
+    }
+}
+
+void serveRealtime(int fd) {
+    for (;;) {
+        uint8_t frame[1500];
+        if (recv(fd, frame, sizeof(frame), 0) <= 0) continue;
+        std::lock_guard<std::mutex> guard(statsLock);
+        stats.realtimeFrames++;
+        stats.lastFrameMs = millis();
+        if (!node.live) {
+            node.live = true;
+            pushState();
+        }
+    }
+}
+
+}  // namespace
+
+namespace sim {
+
+void startWledStandIn() {
+    std::thread(serveHttp, listenOn(SOCK_STREAM, 80)).detach();
+    std::thread(serveRealtime, listenOn(SOCK_DGRAM, 21324)).detach();
+}
+
+void setWledDelayMs(unsigned long delayMs) {
+    responseDelayMs = delayMs;
+}
+
+void setWledState(int red, int green, int blue, int effect, int brightness) {
+    std::lock_guard<std::mutex> guard(statsLock);
+    node.red = red;
+    node.green = green;
+    node.blue = blue;
+    node.effect = effect;
+    node.brightness = brightness;
+    node.live = false;
+    pushState();
+}
+
+WledStats wledStats() {
+    std::lock_guard<std::mutex> guard(statsLock);
+    return stats;
+}
+
+}  // namespace sim
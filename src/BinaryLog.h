@@ -0,0 +1,108 @@
+#pragma once
+
+#include <Arduino.h>
+#include <type_traits>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "config.h"
+#include "LogFormats.h"
+#include "MpscRing.h"
+
+// Deferred logging: LOG() stores a format ID and up to MAX_ARGS raw
+// arguments in a lock-free ring, which takes a few dozen cycles and is
+// safe from any task or ISR. A drain task formats the records and writes
+// them to Serial, so hot paths never wait on the UART or build Strings.
+class BinaryLog {
+public:
+    static constexpr size_t MAX_ARGS = 8;
+
+    struct Record {
+        LogFormat format;
+        uintptr_t args[MAX_ARGS];
+    };
+
+    BinaryLog() : taskHandle(nullptr) {}
+    bool begin();
+
+    template <typename... Args>
+    void record(LogFormat format, Args... args) {
+        static_assert(sizeof...(Args) <= MAX_ARGS, "Too many log arguments");
+        Record entry{format, {toArg(args)...}};
+        ring.push(entry);
+    }
+
+    uint32_t getDropped() const { return ring.getOverflows(); }
+
+private:
+    MpscRing<Record, Tasks::LOG_RING_SIZE> ring;
+    TaskHandle_t taskHandle;
+
+    // Integers (promoted to register width) and long-lived strings only
+    static uintptr_t toArg(const char* text) { return reinterpret_cast<uintptr_t>(text); }
+    static uintptr_t toArg(char* text) { return reinterpret_cast<uintptr_t>(text); }
+    template <typename T>
+    static uintptr_t toArg(T value) {
+        static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                      "Log arguments must be integers or static strings");
+        return static_cast<uintptr_t>(value);
+    }
+
+    static void taskEntry(void* param);
+    void drain();
+};
+
+extern BinaryLog debugLog;
+
+// Never runs: has -Wformat check each call's arguments against its text,
+// which the drain task can no longer do once they are raw words
+#define LOG_CHECK(format, ...) if (false) printf(LogText::format, ##__VA_ARGS__)
+
+#if DEBUG
+  #define LOG(format, ...) do { \
+      LOG_CHECK(format, ##__VA_ARGS__); \
+      debugLog.record(LogFormat::format, ##__VA_ARGS__); \
+  } while (0)
+#else
+  // Still evaluates the arguments, so values computed only for logging stay used
+  #define LOG(format, ...) do { LOG_CHECK(format, ##__VA_ARGS__); } while (0)
+#endif
+
+bool BinaryLog::begin() {
+    if (xTaskCreate(taskEntry, "log", Tasks::LOG_STACK_SIZE, this,
+                    Tasks::LOG_PRIORITY, &taskHandle) != pdPASS) {
+        DEBUG_PRINTLN("Log drain task creation failed");
+        taskHandle = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void BinaryLog::taskEntry(void* param) {
+    static_cast<BinaryLog*>(param)->drain();
+}
+
+void BinaryLog::drain() {
+    static const char* const FORMATS[] = {
+#define LOG_FORMAT_TEXT(id, text) LogText::id,
+        LOG_FORMATS(LOG_FORMAT_TEXT)
+#undef LOG_FORMAT_TEXT
+    };
+
+    uint32_t reportedDrops = 0;
+    Record entry;
+    for (;;) {
+        while (ring.pop(entry)) {
+            const size_t index = static_cast<size_t>(entry.format);
+            if (index >= static_cast<size_t>(LogFormat::COUNT)) continue;
+            const uintptr_t* a = entry.args;
+            Serial.printf(FORMATS[index], a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]);
+        }
+
+        uint32_t dropped = ring.getOverflows();
+        if (dropped != reportedDrops) {
+            Serial.printf("[log] %lu records dropped\n", static_cast<unsigned long>(dropped - reportedDrops));
+            reportedDrops = dropped;
+        }
+        vTaskDelay(pdMS_TO_TICKS(Timing::LOG_DRAIN_INTERVAL));
+    }
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <soc/soc.h>
+#include <soc/gpio_reg.h>
+#include "config.h"
+#include "InputEventQueue.h"
+
+// What the scan has cost, next to what the per-edge interrupts it replaced
+// would have cost for the same presses
+struct ButtonScanStats {
+    uint32_t scans;
+    uint32_t averageScanNs;
+    uint32_t maxScanUs;
+    uint32_t scanTimeUs;            // All scans since boot
+    uint32_t edges;                 // Level changes between samples
+    uint32_t edgeIsrEstimateUs;     // edges x Buttons::EDGE_ISR_ESTIMATE_US, a lower bound:
+                                    // bounces shorter than a scan interval are not seen
+    uint32_t presses;
+    uint32_t longPresses;
+    uint32_t repeats;
+};
+
+// Debounces every button from one periodic timer callback instead of an
+// interrupt per edge. Each scan reads all button pins with a single
+// GPIO_IN_REG load and moves each button's integrator one step toward the
+// sampled level; the debounced state only flips when an integrator reaches
+// either end, so a bouncing contact costs nothing beyond the scans.
+class ButtonScanner {
+public:
+    ButtonScanner();
+    bool begin(InputEventQueue& queue);
+
+    ButtonScanStats getStats();
+
+private:
+    struct Button {
+        uint32_t mask;              // Bit in GPIO_IN_REG
+        Buttons::ID id;
+        uint8_t integrator;         // 0 = released ... DEBOUNCE_TICKS = pressed
+        bool pressed;               // Debounced state
+        bool sampledDown;           // Last raw sample
+        bool held;                  // LONG_PRESS sent for this press
+        uint32_t firstEdgeUs;       // Start of the press being debounced
+        unsigned long nextHoldMs;   // When the next LONG_PRESS or REPEAT is due
+    };
+
+    // All button pins sit in GPIO_IN_REG, so one load samples them all
+    static_assert(Pins::RED_BUTTON < 32 && Pins::GREEN_BUTTON < 32 &&
+                  Pins::BLUE_BUTTON < 32 && Pins::EFFECT_BUTTON < 32,
+                  "Button pins must be GPIO0-31");
+
+    Button buttons[Buttons::NUM_BUTTONS];
+    InputEventQueue* queuePtr;
+    esp_timer_handle_t timer;
+    uint32_t cyclesPerUs;
+
+    // Written by the timer task only; statsLock keeps a reader's copy whole
+    portMUX_TYPE statsLock;
+    uint32_t scans;
+    uint64_t scanCycles;
+    uint32_t maxScanCycles;
+    uint32_t edges;
+    uint32_t presses;
+    uint32_t longPresses;
+    uint32_t repeats;
+
+    static void timerEntry(void* param);
+    void scan();
+    void emit(Button& button, ButtonAction action, uint32_t timestampUs);
+};
+
+ButtonScanner::ButtonScanner() :
+    buttons{
+        {1UL << Pins::RED_BUTTON, Buttons::ID::RED_ID, 0, false, false, false, 0, 0},
+        {1UL << Pins::GREEN_BUTTON, Buttons::ID::GREEN_ID, 0, false, false, false, 0, 0},
+        {1UL << Pins::BLUE_BUTTON, Buttons::ID::BLUE_ID, 0, false, false, false, 0, 0},
+        {1UL << Pins::EFFECT_BUTTON, Buttons::ID::EFFECT_ID, 0, false, false, false, 0, 0}
+    },
+    queuePtr(nullptr),
+    timer(nullptr),
+    cyclesPerUs(1),
+    statsLock(portMUX_INITIALIZER_UNLOCKED),
+    scans(0),
+    scanCycles(0),
+    maxScanCycles(0),
+    edges(0),
+    presses(0),
+    longPresses(0),
+    repeats(0) {}
+
+// Pins must already be inputs with pull-ups
+bool ButtonScanner::begin(InputEventQueue& queue) {
+    queuePtr = &queue;
+    cyclesPerUs = ESP.getCpuFreqMHz();
+
+    const esp_timer_create_args_t args = {
+        .callback = timerEntry,
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "buttons",
+        .skip_unhandled_events = true   // A late scan just runs once, it does not catch up
+    };
+    if (esp_timer_create(&args, &timer) != ESP_OK ||
+        esp_timer_start_periodic(timer, Buttons::SCAN_INTERVAL_US) != ESP_OK) {
+        DEBUG_PRINTLN("Button scan timer failed to start");
+        return false;
+    }
+    return true;
+}
+
+void ButtonScanner::timerEntry(void* param) {
+    static_cast<ButtonScanner*>(param)->scan();
+}
+
+void ButtonScanner::scan() {
+    const uint32_t startCycles = ESP.getCycleCount();
+    const uint32_t levels = REG_READ(GPIO_IN_REG);
+    const uint32_t nowUs = micros();
+    const unsigned long nowMs = millis();
+    uint32_t settling = 0;
+    uint32_t newEdges = 0;
+
+    for (Button& button : buttons) {
+        const bool down = (levels & button.mask) == 0;  // Pulled up, pressed pulls low
+        if (down != button.sampledDown) {
+            button.sampledDown = down;
+            newEdges++;
+        }
+
+        if (down) {
+            if (button.integrator == 0 && !button.pressed) button.firstEdgeUs = nowUs;
+            if (button.integrator < Buttons::DEBOUNCE_TICKS) button.integrator++;
+        } else if (button.integrator > 0) {
+            button.integrator--;
+        }
+        if (button.integrator > 0 && button.integrator < Buttons::DEBOUNCE_TICKS) settling++;
+
+        if (!button.pressed && button.integrator == Buttons::DEBOUNCE_TICKS) {
+            button.pressed = true;
+            button.held = false;
+            button.nextHoldMs = nowMs + Buttons::LONG_PRESS_MS;
+            emit(button, ButtonAction::PRESSED, button.firstEdgeUs);
+        } else if (button.pressed && button.integrator == 0) {
+            button.pressed = false;
+            emit(button, ButtonAction::RELEASED, nowUs);
+        } else if (button.pressed && static_cast<long>(nowMs - button.nextHoldMs) >= 0) {
+            emit(button, button.held ? ButtonAction::REPEAT : ButtonAction::LONG_PRESS, nowUs);
+            button.held = true;
+            button.nextHoldMs += Buttons::REPEAT_INTERVAL_MS;
+        }
+    }
+    queuePtr->countScan(settling);
+
+    const uint32_t cycles = ESP.getCycleCount() - startCycles;
+    portENTER_CRITICAL(&statsLock);
+    scans++;
+    scanCycles += cycles;
+    if (cycles > maxScanCycles) maxScanCycles = cycles;
+    edges += newEdges;
+    portEXIT_CRITICAL(&statsLock);
+}
+
+void ButtonScanner::emit(Button& button, ButtonAction action, uint32_t timestampUs) {
+    queuePtr->push(InputEvent::button(button.id, action, timestampUs));
+    portENTER_CRITICAL(&statsLock);
+    if (action == ButtonAction::PRESSED) presses++;
+    else if (action == ButtonAction::LONG_PRESS) longPresses++;
+    else if (action == ButtonAction::REPEAT) repeats++;
+    portEXIT_CRITICAL(&statsLock);
+}
+
+ButtonScanStats ButtonScanner::getStats() {
+    portENTER_CRITICAL(&statsLock);
+    const uint32_t scanCount = scans;
+    const uint64_t cycles = scanCycles;
+    const uint32_t maxCycles = maxScanCycles;
+    const uint32_t edgeCount = edges;
+    ButtonScanStats stats{};
+    stats.presses = presses;
+    stats.longPresses = longPresses;
+    stats.repeats = repeats;
+    portEXIT_CRITICAL(&statsLock);
+
+    stats.scans = scanCount;
+    stats.averageScanNs = scanCount ? static_cast<uint32_t>(cycles * 1000 / cyclesPerUs / scanCount) : 0;
+    stats.maxScanUs = maxCycles / cyclesPerUs;
+    stats.scanTimeUs = static_cast<uint32_t>(cycles / cyclesPerUs);
+    stats.edges = edgeCount;
+    stats.edgeIsrEstimateUs = edgeCount * Buttons::EDGE_ISR_ESTIMATE_US;
+    return stats;
+}
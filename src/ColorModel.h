@@ -0,0 +1,272 @@
+#pragma once
+
+#include <Arduino.h>
+#include <limits.h>
+#include "config.h"
+
+// 8-bit color as sent to WLED
+struct Rgb8 {
+    uint8_t red;
+    uint8_t green;
+    uint8_t blue;
+};
+
+// Lookup tables for the color modes, generated by the compiler from
+// ColorConfig. Converting knob positions to a color is then table loads
+// and integer multiplies; nothing calls pow() at run time.
+namespace ColorTables {
+    template <typename T, size_t N>
+    struct Table {
+        T values[N];
+    };
+
+    // C++11 has no std::index_sequence; this builds 0..N-1 for the tables
+    template <size_t... I> struct Indices {};
+    template <size_t N, size_t... I> struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+    template <size_t... I> struct MakeIndices<0, I...> { typedef Indices<I...> type; };
+
+    // Compile-time pow() for 0 <= x <= 1: the integer part of the exponent
+    // by multiplication, the fraction from its binary digits by repeated
+    // square roots (x^0.5, x^0.25, ...)
+    constexpr double sqrtStep(double x, double guess, int steps) {
+        return steps == 0 ? guess : sqrtStep(x, 0.5 * (guess + x / guess), steps - 1);
+    }
+    constexpr double squareRoot(double x) { return x <= 0 ? 0 : sqrtStep(x, 1.0, 30); }
+    constexpr double powInteger(double x, int n) { return n == 0 ? 1 : x * powInteger(x, n - 1); }
+    constexpr double powFraction(double root, double fraction, int bits) {
+        return bits == 0 || fraction <= 0 ? 1
+             : fraction >= 0.5 ? root * powFraction(squareRoot(root), fraction * 2 - 1, bits - 1)
+                               : powFraction(squareRoot(root), fraction * 2, bits - 1);
+    }
+    constexpr double power(double x, double exponent) {
+        return powInteger(x, static_cast<int>(exponent)) *
+               powFraction(squareRoot(x), exponent - static_cast<int>(exponent), 16);
+    }
+
+    // Knob position to output level. Any position above 0 lights the LEDs,
+    // so the bottom of the knob is not a dead zone.
+    constexpr uint8_t gammaEntry(size_t i) {
+        return i == 0 ? 0
+             : power(i / 255.0, ColorConfig::GAMMA) * 255 < 1 ? 1
+             : static_cast<uint8_t>(power(i / 255.0, ColorConfig::GAMMA) * 255 + 0.5);
+    }
+
+    // Fully saturated hue wheel: six sectors, each ramping one primary
+    constexpr Rgb8 hueColor(unsigned sector, uint8_t ramp) {
+        return sector == 0 ? Rgb8{255, ramp, 0}
+             : sector == 1 ? Rgb8{static_cast<uint8_t>(255 - ramp), 255, 0}
+             : sector == 2 ? Rgb8{0, 255, ramp}
+             : sector == 3 ? Rgb8{0, static_cast<uint8_t>(255 - ramp), 255}
+             : sector == 4 ? Rgb8{ramp, 0, 255}
+                           : Rgb8{255, 0, static_cast<uint8_t>(255 - ramp)};
+    }
+    constexpr Rgb8 hueEntry(size_t hue) {
+        return hueColor(hue * 6 / 256, static_cast<uint8_t>(hue * 6 % 256));
+    }
+
+    // Blackbody white points (sRGB, normalized to the brightest primary),
+    // every 500 K from 1500 K to 10000 K
+    constexpr Rgb8 WHITE_POINTS[] = {
+        {255, 109, 0}, {255, 137, 18}, {255, 161, 72}, {255, 180, 107}, {255, 196, 137},
+        {255, 209, 163}, {255, 219, 186}, {255, 228, 206}, {255, 236, 224}, {255, 243, 239},
+        {255, 249, 253}, {245, 243, 255}, {235, 238, 255}, {227, 233, 255}, {220, 229, 255},
+        {214, 225, 255}, {208, 222, 255}, {204, 219, 255}
+    };
+    constexpr uint16_t WHITE_POINT_FIRST_K = 1500;
+    constexpr uint16_t WHITE_POINT_STEP_K = 500;
+    static_assert(ColorConfig::TEMPERATURE_MIN_K >= WHITE_POINT_FIRST_K &&
+                  ColorConfig::TEMPERATURE_MAX_K <= WHITE_POINT_FIRST_K + 17 * WHITE_POINT_STEP_K &&
+                  ColorConfig::TEMPERATURE_MIN_K < ColorConfig::TEMPERATURE_MAX_K,
+                  "Temperature range must lie within the white point table");
+
+    constexpr uint16_t kelvinAt(size_t position) {
+        return ColorConfig::TEMPERATURE_MIN_K +
+               (ColorConfig::TEMPERATURE_MAX_K - ColorConfig::TEMPERATURE_MIN_K) * position / 255;
+    }
+    constexpr uint8_t blend(uint8_t from, uint8_t to, unsigned weight) {
+        return static_cast<uint8_t>((from * (WHITE_POINT_STEP_K - weight) + to * weight) / WHITE_POINT_STEP_K);
+    }
+    constexpr Rgb8 whiteBetween(size_t below, unsigned weight) {
+        return weight == 0 ? WHITE_POINTS[below]
+             : Rgb8{blend(WHITE_POINTS[below].red, WHITE_POINTS[below + 1].red, weight),
+                    blend(WHITE_POINTS[below].green, WHITE_POINTS[below + 1].green, weight),
+                    blend(WHITE_POINTS[below].blue, WHITE_POINTS[below + 1].blue, weight)};
+    }
+    constexpr Rgb8 temperatureEntry(size_t position) {
+        return whiteBetween((kelvinAt(position) - WHITE_POINT_FIRST_K) / WHITE_POINT_STEP_K,
+                            (kelvinAt(position) - WHITE_POINT_FIRST_K) % WHITE_POINT_STEP_K);
+    }
+
+    template <size_t... I>
+    constexpr Table<uint8_t, 256> makeGamma(Indices<I...>) { return Table<uint8_t, 256>{{gammaEntry(I)...}}; }
+    template <size_t... I>
+    constexpr Table<Rgb8, 256> makeHues(Indices<I...>) { return Table<Rgb8, 256>{{hueEntry(I)...}}; }
+    template <size_t... I>
+    constexpr Table<Rgb8, 256> makeTemperatures(Indices<I...>) {
+        return Table<Rgb8, 256>{{temperatureEntry(I)...}};
+    }
+
+    constexpr Table<uint8_t, 256> GAMMA = makeGamma(MakeIndices<256>::type());
+    constexpr Table<Rgb8, 256> HUES = makeHues(MakeIndices<256>::type());
+    constexpr Table<Rgb8, 256> TEMPERATURES = makeTemperatures(MakeIndices<256>::type());
+
+    static_assert(GAMMA.values[0] == 0 && GAMMA.values[1] == 1 && GAMMA.values[255] == 255,
+                  "Gamma table must span 0-255");
+}
+
+// Converts between the three knob positions of a color mode and the RGB
+// color sent to WLED. The knobs are always 0-255; what they mean depends
+// on the mode.
+class ColorModel {
+public:
+    static constexpr size_t KNOBS = 3;
+    typedef uint8_t Knobs[KNOBS];
+
+    static Rgb8 toRgb(ColorMode mode, const Knobs& knobs);
+    // Knob positions that come closest to color, for following changes
+    // made elsewhere and for switching modes without a jump
+    static void fromRgb(ColorMode mode, const Rgb8& color, Knobs& knobs);
+    // Knob positions for the red, green or blue preset button (0-2)
+    static void preset(ColorMode mode, size_t button, Knobs& knobs);
+
+    static ColorMode next(ColorMode mode);
+    static const char* modeName(ColorMode mode);
+    // Three letters for the display
+    static const char* modeTag(ColorMode mode);
+    // One-letter knob labels, e.g. "HSV"; a space marks an unused knob
+    static const char* knobLabels(ColorMode mode);
+    static bool usesKnob(ColorMode mode, size_t knob) { return knobLabels(mode)[knob] != ' '; }
+    static uint16_t temperatureK(uint8_t position) { return ColorTables::kelvinAt(position); }
+
+private:
+    static uint8_t scale(uint8_t value, uint8_t level) { return (value * level + 127) / 255; }
+    static uint8_t inverseGamma(uint8_t level);
+};
+
+Rgb8 ColorModel::toRgb(ColorMode mode, const Knobs& knobs) {
+    switch (mode) {
+        case ColorMode::HSV: {
+            const Rgb8& hue = ColorTables::HUES.values[knobs[0]];
+            const uint8_t level = ColorTables::GAMMA.values[knobs[2]];
+            const uint8_t white = 255 - knobs[1];   // Saturation pulls every primary toward full
+            return Rgb8{scale(hue.red + scale(255 - hue.red, white), level),
+                        scale(hue.green + scale(255 - hue.green, white), level),
+                        scale(hue.blue + scale(255 - hue.blue, white), level)};
+        }
+        case ColorMode::TEMPERATURE: {
+            const Rgb8& white = ColorTables::TEMPERATURES.values[knobs[0]];
+            const uint8_t level = ColorTables::GAMMA.values[knobs[1]];
+            return Rgb8{scale(white.red, level), scale(white.green, level), scale(white.blue, level)};
+        }
+        default:
+            return Rgb8{ColorTables::GAMMA.values[knobs[0]], ColorTables::GAMMA.values[knobs[1]],
+                        ColorTables::GAMMA.values[knobs[2]]};
+    }
+}
+
+void ColorModel::fromRgb(ColorMode mode, const Rgb8& color, Knobs& knobs) {
+    const uint8_t top = max(color.red, max(color.green, color.blue));
+    const uint8_t bottom = min(color.red, min(color.green, color.blue));
+    switch (mode) {
+        case ColorMode::HSV: {
+            knobs[2] = inverseGamma(top);
+            if (top == 0) return;   // Black: keep hue and saturation
+            knobs[1] = 255 - bottom * 255 / top;
+            const int delta = top - bottom;
+            if (delta == 0) return;  // Gray: keep the hue
+            // Position on the 1536-step wheel the hue table is cut from
+            int wheel;
+            if (top == color.red) wheel = 256 * (color.green - color.blue) / delta;
+            else if (top == color.green) wheel = 512 + 256 * (color.blue - color.red) / delta;
+            else wheel = 1024 + 256 * (color.red - color.green) / delta;
+            if (wheel < 0) wheel += 1536;
+            knobs[0] = min(wheel / 6, 255);
+            return;
+        }
+        case ColorMode::TEMPERATURE: {
+            knobs[1] = inverseGamma(top);
+            knobs[2] = 0;   // Unused
+            if (top == 0) return;
+            // The white whose proportions match best; not the hot path
+            int bestDistance = INT_MAX;
+            for (int position = 0; position < 256; position++) {
+                const Rgb8& white = ColorTables::TEMPERATURES.values[position];
+                const int distance = abs(scale(white.red, top) - color.red) +
+                                     abs(scale(white.green, top) - color.green) +
+                                     abs(scale(white.blue, top) - color.blue);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    knobs[0] = position;
+                }
+            }
+            return;
+        }
+        default:
+            knobs[0] = inverseGamma(color.red);
+            knobs[1] = inverseGamma(color.green);
+            knobs[2] = inverseGamma(color.blue);
+            return;
+    }
+}
+
+void ColorModel::preset(ColorMode mode, size_t button, Knobs& knobs) {
+    switch (mode) {
+        case ColorMode::HSV:
+            knobs[0] = ColorConfig::PRESET_HUES[button];
+            knobs[1] = 255;
+            knobs[2] = Buttons::PRESET_VALUE;
+            return;
+        case ColorMode::TEMPERATURE:
+            knobs[0] = (ColorConfig::PRESET_TEMPERATURES_K[button] - ColorConfig::TEMPERATURE_MIN_K) * 255 /
+                       (ColorConfig::TEMPERATURE_MAX_K - ColorConfig::TEMPERATURE_MIN_K);
+            knobs[1] = Buttons::PRESET_VALUE;
+            knobs[2] = 0;
+            return;
+        default:
+            for (size_t i = 0; i < KNOBS; i++) knobs[i] = i == button ? Buttons::PRESET_VALUE : 0;
+            return;
+    }
+}
+
+ColorMode ColorModel::next(ColorMode mode) {
+    const uint8_t index = static_cast<uint8_t>(mode) + 1;
+    return index < static_cast<uint8_t>(ColorMode::COUNT) ? static_cast<ColorMode>(index) : ColorMode::RGB;
+}
+
+const char* ColorModel::modeName(ColorMode mode) {
+    switch (mode) {
+        case ColorMode::HSV: return "hsv";
+        case ColorMode::TEMPERATURE: return "temperature";
+        default: return "rgb";
+    }
+}
+
+const char* ColorModel::modeTag(ColorMode mode) {
+    switch (mode) {
+        case ColorMode::HSV: return "HSV";
+        case ColorMode::TEMPERATURE: return "CCT";
+        default: return "RGB";
+    }
+}
+
+const char* ColorModel::knobLabels(ColorMode mode) {
+    switch (mode) {
+        case ColorMode::HSV: return "HSV";
+        case ColorMode::TEMPERATURE: return "KL ";
+        default: return "RGB";
+    }
+}
+
+// Lowest knob position whose output reaches level, or the one just below
+// when it is nearer (binary search over the gamma table)
+uint8_t ColorModel::inverseGamma(uint8_t level) {
+    int low = 0;
+    int high = 255;
+    while (low < high) {
+        const int middle = (low + high) / 2;
+        if (ColorTables::GAMMA.values[middle] < level) low = middle + 1;
+        else high = middle;
+    }
+    if (low > 0 && level - ColorTables::GAMMA.values[low - 1] < ColorTables::GAMMA.values[low] - level) low--;
+    return low;
+}
@@ -2,22 +2,69 @@
 
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
 #include "config.h"
+#include "EffectCatalog.h"
+#include "ColorModel.h"
+#include "BinaryLog.h"
+
+// Everything the renderer needs for one frame, copied out of loop()
+struct DisplaySnapshot {
+    ColorMode colorMode;
+    ColorModel::Knobs knobs;
+    int effectIndex;
+};
 
 class DisplayHandler {
 public:
     DisplayHandler();
-    bool begin();
-    void updateDisplay(int redValue, int greenValue, int blueValue);
+    // Effect names are looked up in catalog at render time
+    bool begin(const EffectCatalog& catalog);
+
+    // Non-blocking: hand the latest state to the display task. A snapshot
+    // that has not been rendered yet is replaced, never queued behind.
+    // The bars show the color knobs in the current mode, which is shown too
+    void updateDisplay(ColorMode colorMode, const ColorModel::Knobs& knobs, int effectIndex);
+
+    uint32_t getFramesPublished() const { return framesPublished; }
+    uint32_t getFramesDropped() const { return framesDropped; }
+
+    // I2C bytes (address and control bytes included) of the last flush and overall
+    size_t getLastFrameBytes() const { return lastFrameBytes; }
+    uint32_t getTotalBytes() const { return totalBytes; }
 
 private:
+    static constexpr int PAGES = SCREEN_HEIGHT / 8;
+    static constexpr size_t BUFFER_SIZE = SCREEN_WIDTH * PAGES;
+    // What display() puts on the bus for a whole frame, for comparison
+    static constexpr size_t FULL_FRAME_BYTES =
+        BUFFER_SIZE + 2 * ((BUFFER_SIZE + I2C::MAX_DATA_CHUNK - 1) / I2C::MAX_DATA_CHUNK) + 8;
+
     Adafruit_SSD1306 display;
+    const EffectCatalog* catalogPtr = nullptr;
+    TaskHandle_t taskHandle = nullptr;
+    QueueHandle_t snapshotQueue = nullptr;  // Single-slot mailbox
+    volatile uint32_t framesPublished = 0;
+    volatile uint32_t framesDropped = 0;
+
+    static void taskEntry(void* param);
+    void render(const DisplaySnapshot& snapshot);
     void drawTestPattern();
+    void flushFull();
+    void flushDirty();
+    void sendPageSpan(int page, int firstColumn, int lastColumn, const uint8_t* data);
+
+    // Copy of what the panel currently shows, to find changed columns
+    uint8_t shadow[BUFFER_SIZE];
+    size_t lastFrameBytes = 0;
+    uint32_t totalBytes = 0;
     
     // Track last values to prevent unnecessary updates
-    int lastRed = -1;
-    int lastGreen = -1;
-    int lastBlue = -1;
+    ColorMode lastMode = ColorMode::COUNT;
+    int lastKnobs[ColorModel::KNOBS] = {-1, -1, -1};
+    const char* lastEffectName = nullptr;   // Changes with the index or the catalog
     unsigned long updateCount = 0;
 };
 
@@ -26,8 +73,9 @@ DisplayHandler::DisplayHandler()
     Serial.println("Display Handler constructor called");
 }
 
-bool DisplayHandler::begin() {
+bool DisplayHandler::begin(const EffectCatalog& catalog) {
     Serial.println("Starting display initialization...");
+    catalogPtr = &catalog;
     
     Wire.begin(I2C::SDA_PIN, I2C::SCL_PIN);
     Wire.setClock(I2C::FREQUENCY);
@@ -43,12 +91,44 @@ bool DisplayHandler::begin() {
     display.clearDisplay();
     display.setTextSize(1);
     display.setTextColor(SSD1306_WHITE);
+    display.setTextWrap(false);     // Long effect names are cut at the edge
     
     drawTestPattern();
+
+    // From here on only the display task touches the panel and the I2C bus
+    snapshotQueue = xQueueCreate(1, sizeof(DisplaySnapshot));
+    if (snapshotQueue == nullptr ||
+        xTaskCreate(taskEntry, "display", Tasks::DISPLAY_STACK_SIZE, this,
+                    Tasks::DISPLAY_PRIORITY, &taskHandle) != pdPASS) {
+        Serial.println("Display task creation failed, rendering inline");
+        taskHandle = nullptr;
+    }
     
     return true;
 }
 
+void DisplayHandler::updateDisplay(ColorMode colorMode, const ColorModel::Knobs& knobs, int effectIndex) {
+    DisplaySnapshot snapshot{colorMode, {knobs[0], knobs[1], knobs[2]}, effectIndex};
+    if (taskHandle == nullptr) {
+        render(snapshot);
+        return;
+    }
+
+    framesPublished++;
+    if (uxQueueMessagesWaiting(snapshotQueue) > 0) framesDropped++;
+    xQueueOverwrite(snapshotQueue, &snapshot);
+}
+
+void DisplayHandler::taskEntry(void* param) {
+    DisplayHandler* self = static_cast<DisplayHandler*>(param);
+    DisplaySnapshot snapshot;
+    for (;;) {
+        if (xQueueReceive(self->snapshotQueue, &snapshot, portMAX_DELAY) == pdTRUE) {
+            self->render(snapshot);
+        }
+    }
+}
+
 void DisplayHandler::drawTestPattern() {
     Serial.println("Drawing test pattern...");
     display.clearDisplay();
@@ -62,69 +142,118 @@ void DisplayHandler::drawTestPattern() {
     
     display.setCursor(10, 20);
     display.print("Display Test");
-    display.display();
-    
-    Serial.println("Test pattern sent to display");
-    delay(2000);
     
+    // Stays up only until the first frame replaces it; boot does not wait
+    flushFull();
     display.clearDisplay();
+    Serial.println("Test pattern sent to display");
+}
+
+void DisplayHandler::flushFull() {
     display.display();
+    memcpy(shadow, display.getBuffer(), BUFFER_SIZE);
+}
+
+void DisplayHandler::flushDirty() {
+    const uint8_t* buffer = display.getBuffer();
+    lastFrameBytes = 0;
+
+    // The buffer is page-major: byte (page * width + x) holds 8 vertical pixels
+    for (int page = 0; page < PAGES; page++) {
+        const int rowStart = page * SCREEN_WIDTH;
+        int first = 0;
+        while (first < SCREEN_WIDTH && buffer[rowStart + first] == shadow[rowStart + first]) first++;
+        if (first == SCREEN_WIDTH) continue;
+
+        int last = SCREEN_WIDTH - 1;
+        while (buffer[rowStart + last] == shadow[rowStart + last]) last--;
+
+        sendPageSpan(page, first, last, buffer + rowStart + first);
+        memcpy(shadow + rowStart + first, buffer + rowStart + first, last - first + 1);
+    }
+    totalBytes += lastFrameBytes;
 }
 
-void DisplayHandler::updateDisplay(int redValue, int greenValue, int blueValue) {
+void DisplayHandler::sendPageSpan(int page, int firstColumn, int lastColumn, const uint8_t* data) {
+    // Restrict the GDDRAM write window to this span (horizontal addressing mode)
+    Wire.beginTransmission(SCREEN_ADDRESS);
+    Wire.write((uint8_t)0x00);  // Command stream
+    Wire.write((uint8_t)SSD1306_PAGEADDR);
+    Wire.write((uint8_t)page);
+    Wire.write((uint8_t)page);
+    Wire.write((uint8_t)SSD1306_COLUMNADDR);
+    Wire.write((uint8_t)firstColumn);
+    Wire.write((uint8_t)lastColumn);
+    Wire.endTransmission();
+    lastFrameBytes += 8;  // Address byte, control byte and six command bytes
+
+    size_t remaining = lastColumn - firstColumn + 1;
+    while (remaining > 0) {
+        size_t chunk = min(remaining, I2C::MAX_DATA_CHUNK);
+        Wire.beginTransmission(SCREEN_ADDRESS);
+        Wire.write((uint8_t)0x40);  // Data stream
+        Wire.write(data, chunk);
+        Wire.endTransmission();
+        lastFrameBytes += chunk + 2;
+        data += chunk;
+        remaining -= chunk;
+    }
+}
+
+void DisplayHandler::render(const DisplaySnapshot& snapshot) {
+    const char* effectName = catalogPtr->getEffectName(snapshot.effectIndex);
+
     // Only update if values have changed
-    if (redValue == lastRed && greenValue == lastGreen && blueValue == lastBlue) {
+    if (snapshot.colorMode == lastMode && snapshot.knobs[0] == lastKnobs[0] &&
+        snapshot.knobs[1] == lastKnobs[1] && snapshot.knobs[2] == lastKnobs[2] &&
+        effectName == lastEffectName) {
         return;
     }
     
     // Store new values
-    lastRed = redValue;
-    lastGreen = greenValue;
-    lastBlue = blueValue;
+    lastMode = snapshot.colorMode;
+    for (size_t i = 0; i < ColorModel::KNOBS; i++) lastKnobs[i] = snapshot.knobs[i];
+    lastEffectName = effectName;
     
-    // Debug print every update
-    DEBUG_PRINTF("Display Update #%d - R:%d G:%d B:%d\n", 
-                 ++updateCount, redValue, greenValue, blueValue);
     
     display.clearDisplay();
 
     const int usableWidth = SCREEN_WIDTH - (2 * DisplayConfig::MARGIN);
     const int barSpacing = (usableWidth - (3 * DisplayConfig::BAR_WIDTH)) / 2;
-    const int baseX = DisplayConfig::MARGIN;
-    
-    const int redHeight = (redValue * DisplayConfig::MAX_HEIGHT) / 255;
-    const int greenHeight = (greenValue * DisplayConfig::MAX_HEIGHT) / 255;
-    const int blueHeight = (blueValue * DisplayConfig::MAX_HEIGHT) / 255;
-    
-    const int greenX = baseX + DisplayConfig::BAR_WIDTH + barSpacing;
-    const int blueX = greenX + DisplayConfig::BAR_WIDTH + barSpacing;
-    
-    // Draw bars and labels
-    display.fillRect(baseX, DisplayConfig::BASE_Y - redHeight, 
-                    DisplayConfig::BAR_WIDTH, redHeight, SSD1306_WHITE);
-    display.fillRect(greenX, DisplayConfig::BASE_Y - greenHeight, 
-                    DisplayConfig::BAR_WIDTH, greenHeight, SSD1306_WHITE);
-    display.fillRect(blueX, DisplayConfig::BASE_Y - blueHeight, 
-                    DisplayConfig::BAR_WIDTH, blueHeight, SSD1306_WHITE);
-    
-    // Draw labels
-    display.setCursor(baseX + 5, DisplayConfig::BASE_Y + 2);
-    display.print("R");
-    display.setCursor(greenX + 5, DisplayConfig::BASE_Y + 2);
-    display.print("G");
-    display.setCursor(blueX + 5, DisplayConfig::BASE_Y + 2);
-    display.print("B");
-    
-    // Draw values
-    display.setCursor(baseX, 2);
-    display.print("R-");
-    display.print(redValue);
-    display.setCursor(greenX, 2);
-    display.print("G-");
-    display.print(greenValue);
-    display.setCursor(blueX, 2);
-    display.print("B-");
-    display.print(blueValue);
+    const char* labels = ColorModel::knobLabels(snapshot.colorMode);
+
+    // One bar per knob, labelled for the mode; unused knobs are left blank
+    for (size_t i = 0; i < ColorModel::KNOBS; i++) {
+        if (labels[i] == ' ') continue;
+        const int x = DisplayConfig::MARGIN + i * (DisplayConfig::BAR_WIDTH + barSpacing);
+        const int height = (snapshot.knobs[i] * DisplayConfig::MAX_HEIGHT) / 255;
+        display.fillRect(x, DisplayConfig::BASE_Y - height, DisplayConfig::BAR_WIDTH, height, SSD1306_WHITE);
+
+        display.setCursor(x + 5, DisplayConfig::BASE_Y + 2);
+        display.print(labels[i]);
+
+        // Temperature reads better in kelvin than as a knob position
+        display.setCursor(x, 2);
+        display.print(labels[i]);
+        display.print('-');
+        if (snapshot.colorMode == ColorMode::TEMPERATURE && i == 0) {
+            display.print(static_cast<int>(ColorModel::temperatureK(snapshot.knobs[i])));
+        } else {
+            display.print(static_cast<int>(snapshot.knobs[i]));
+        }
+    }
+
+    // Effect name, cut short where the mode tag starts
+    const int tagX = SCREEN_WIDTH - DisplayConfig::MODE_TAG_WIDTH;
+    display.setCursor(DisplayConfig::MARGIN, DisplayConfig::EFFECT_Y);
+    display.print(effectName);
+    display.fillRect(tagX - 2, DisplayConfig::EFFECT_Y, DisplayConfig::MODE_TAG_WIDTH + 2, 8, SSD1306_BLACK);
+    display.setCursor(tagX, DisplayConfig::EFFECT_Y);
+    display.print(ColorModel::modeTag(snapshot.colorMode));
     
-    display.display();
-}
\ No newline at end of file
+    flushDirty();
+
+    // Debug print every update
+    LOG(DISPLAY_UPDATE, ++updateCount, ColorModel::modeName(snapshot.colorMode),
+        snapshot.knobs[0], snapshot.knobs[1], snapshot.knobs[2], lastFrameBytes, FULL_FRAME_BYTES);
+}
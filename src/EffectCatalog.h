@@ -0,0 +1,460 @@
+#pragma once
+
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include <Preferences.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "config.h"
+#include "BinaryLog.h"
+
+// Where the names in use came from
+enum class CatalogSource : uint8_t {
+    BUILTIN,    // Effects::NAMES
+    FLASH,      // NVS cache of an earlier download
+    WLED        // Downloaded this boot
+};
+
+// Effect and palette names of one WLED node, indexed by WLED's own IDs.
+// /json/eff and /json/pal are scanned as they arrive into one pool where
+// each distinct name is stored once, and the result is cached in NVS with
+// the node's version. A node that has not been upgraded costs one
+// /json/info request per boot and no download.
+class EffectCatalog {
+public:
+    EffectCatalog();
+
+    // Loads the cached catalog (setup(), before the saved state is restored)
+    bool restore();
+    // Starts the task that checks the node's version and downloads on a change
+    bool begin(const char* address);
+
+    // Safe from any task. Names stay valid for the life of the program,
+    // so they may be handed to LOG().
+    int getEffectCount() const { return current().effectCount; }
+    const char* getEffectName(int index) const;
+    // Reserved IDs ("RSVD") are listed by WLED but cannot be selected
+    bool isSelectable(int index) const;
+    // Moves delta selectable effects from index, wrapping at both ends
+    int stepEffect(int index, int delta) const;
+    int getPaletteCount() const { return current().paletteCount; }
+    const char* getPaletteName(int index) const;
+
+    CatalogSource getSource() const { return current().source; }
+    const char* getSourceName() const;
+    const char* getVersion() const { return current().version; }
+    size_t getPoolBytes() const { return current().poolUsed; }
+    uint32_t getDownloads() const { return downloads; }
+    // Moves on with every table published, so caches of names can tell
+    // when to rebuild
+    uint32_t getPublishCount() const { return publishes; }
+
+private:
+    static constexpr size_t VERSION_LENGTH = 32;
+
+    struct Table {
+        CatalogSource source;
+        char version[VERSION_LENGTH];   // "<ver>/<vid>" of the node
+        uint16_t effectCount;
+        uint16_t paletteCount;
+        uint16_t poolUsed;
+        uint16_t effects[Effects::MAX_EFFECTS];     // Offsets into pool
+        uint16_t palettes[Effects::MAX_PALETTES];
+        char pool[Effects::NAME_POOL_SIZE];
+    };
+
+    // A table is filled while it is the spare one and never written again
+    // once published, so readers need no lock. The built-in names give way
+    // to the cache before anything runs, leaving one spare for a download.
+    // Both together are about 10 KB of RAM.
+    Table tables[2];
+    std::atomic<Table*> active;
+    const char* host;
+    TaskHandle_t taskHandle;
+    volatile uint32_t downloads;
+    volatile uint32_t publishes;
+
+    const Table& current() const { return *active.load(std::memory_order_acquire); }
+    Table& spare() { return tables[active.load() == &tables[0] ? 1 : 0]; }
+
+    static void taskEntry(void* param);
+    void runTask();
+    bool refresh();
+    bool fetchVersion(char* version, size_t size);
+    bool fetchNames(const char* path, Table& table, uint16_t* offsets, size_t capacity, uint16_t& count);
+    bool openBody(HTTPClient& http, WiFiClient& client, const char* path);
+    void save(const Table& table);
+
+    static void clearTable(Table& table);
+    static int intern(Table& table, const char* name);
+    static bool reserved(const Table& table, int index);
+    static bool validTable(const Table& table);
+};
+
+// Byte-at-a-time view of an HTTP body, read from the socket in small chunks
+class BodyReader {
+public:
+    BodyReader(WiFiClient* stream, int size) : stream(stream), remaining(size) {}
+
+    // Next byte, -1 at the end of the body or after a stall
+    int next();
+    // Skips ahead until just past pattern; false if the body ends first
+    bool skipPast(const char* pattern);
+
+private:
+    WiFiClient* stream;
+    int remaining;          // -1 when there is no Content-Length
+    uint8_t buffer[64];
+    size_t length = 0;
+    size_t position = 0;
+};
+
+int BodyReader::next() {
+    if (position < length) return buffer[position++];
+    if (stream == nullptr || remaining == 0) return -1;
+
+    unsigned long start = millis();
+    while (millis() - start < NetworkConfig::WLED_TIMEOUT_MS) {
+        size_t available = stream->available();
+        if (available == 0) {
+            if (!stream->connected()) return -1;
+            delay(1);
+            continue;
+        }
+        size_t chunk = min(available, sizeof(buffer));
+        if (remaining > 0) chunk = min(chunk, static_cast<size_t>(remaining));
+        int bytesRead = stream->read(buffer, chunk);
+        if (bytesRead <= 0) return -1;
+        if (remaining > 0) remaining -= bytesRead;
+        length = bytesRead;
+        position = 1;
+        return buffer[0];
+    }
+    return -1;
+}
+
+bool BodyReader::skipPast(const char* pattern) {
+    size_t matched = 0;
+    int c;
+    while (pattern[matched] != '\0' && (c = next()) >= 0) {
+        if (c == pattern[matched]) matched++;
+        else matched = (c == pattern[0]) ? 1 : 0;
+    }
+    return pattern[matched] == '\0';
+}
+
+EffectCatalog::EffectCatalog() :
+    active(&tables[0]),
+    host(nullptr),
+    taskHandle(nullptr),
+    downloads(0),
+    publishes(0) {
+    Table& builtin = tables[0];
+    clearTable(builtin);
+    strncpy(builtin.version, "built-in", VERSION_LENGTH - 1);
+    for (int i = 0; i < Effects::BUILTIN_COUNT; i++) {
+        builtin.effects[builtin.effectCount++] = intern(builtin, Effects::NAMES[i]);
+    }
+}
+
+bool EffectCatalog::restore() {
+    Preferences preferences;
+    if (!preferences.begin(Effects::CACHE_NAMESPACE, true)) return false;
+
+    // The version is written last, so a cache without it is incomplete
+    Table& loaded = spare();
+    clearTable(loaded);
+    const size_t versionLength = preferences.getBytesLength("version");
+    const size_t effectBytes = preferences.getBytesLength("effects");
+    const size_t paletteBytes = preferences.getBytesLength("palettes");
+    const size_t poolBytes = preferences.getBytesLength("names");
+    bool ok = versionLength > 1 && versionLength <= VERSION_LENGTH &&
+              effectBytes > 0 && effectBytes <= sizeof(loaded.effects) &&
+              paletteBytes <= sizeof(loaded.palettes) &&
+              poolBytes > 0 && poolBytes <= sizeof(loaded.pool);
+    if (ok) {
+        preferences.getBytes("version", loaded.version, versionLength);
+        preferences.getBytes("effects", loaded.effects, effectBytes);
+        if (paletteBytes > 0) preferences.getBytes("palettes", loaded.palettes, paletteBytes);
+        preferences.getBytes("names", loaded.pool, poolBytes);
+        loaded.version[VERSION_LENGTH - 1] = '\0';
+        loaded.effectCount = effectBytes / sizeof(uint16_t);
+        loaded.paletteCount = paletteBytes / sizeof(uint16_t);
+        loaded.poolUsed = poolBytes;
+        loaded.source = CatalogSource::FLASH;
+        ok = validTable(loaded);
+    }
+    preferences.end();
+    if (!ok) return false;
+
+    // Nothing has looked up a name yet, so the built-in table is free again
+    active.store(&loaded, std::memory_order_release);
+    publishes++;
+    DEBUG_PRINTF("Effect catalog %s loaded from flash - %u effects, %u palettes\n",
+                 loaded.version, loaded.effectCount, loaded.paletteCount);
+    return true;
+}
+
+bool EffectCatalog::begin(const char* address) {
+    host = address;
+    if (xTaskCreate(taskEntry, "catalog", Tasks::CATALOG_STACK_SIZE, this,
+                    Tasks::CATALOG_PRIORITY, &taskHandle) != pdPASS) {
+        DEBUG_PRINTLN("Effect catalog task creation failed");
+        taskHandle = nullptr;
+        return false;
+    }
+    return true;
+}
+
+const char* EffectCatalog::getEffectName(int index) const {
+    const Table& table = current();
+    if (index < 0 || index >= table.effectCount) return "?";
+    return table.pool + table.effects[index];
+}
+
+bool EffectCatalog::isSelectable(int index) const {
+    const Table& table = current();
+    return index >= 0 && index < table.effectCount && !reserved(table, index);
+}
+
+int EffectCatalog::stepEffect(int index, int delta) const {
+    const Table& table = current();
+    const int count = table.effectCount;
+    if (count == 0) return 0;
+    const int step = delta > 0 ? 1 : -1;
+    for (int moves = abs(delta); moves > 0; moves--) {
+        // At most one lap, in case nothing is selectable
+        for (int tries = 0; tries < count; tries++) {
+            index = ((index + step) % count + count) % count;
+            if (!reserved(table, index)) break;
+        }
+    }
+    return index;
+}
+
+const char* EffectCatalog::getPaletteName(int index) const {
+    const Table& table = current();
+    if (index < 0 || index >= table.paletteCount) return "?";
+    return table.pool + table.palettes[index];
+}
+
+const char* EffectCatalog::getSourceName() const {
+    switch (getSource()) {
+        case CatalogSource::FLASH: return "flash";
+        case CatalogSource::WLED: return "wled";
+        default: return "built-in";
+    }
+}
+
+void EffectCatalog::taskEntry(void* param) {
+    static_cast<EffectCatalog*>(param)->runTask();
+}
+
+// One-shot: waits for the link, then retries until the node has answered
+void EffectCatalog::runTask() {
+    for (;;) {
+        if (WiFi.status() == WL_CONNECTED) {
+            if (refresh()) break;
+            vTaskDelay(pdMS_TO_TICKS(Effects::RETRY_INTERVAL));
+        } else {
+            vTaskDelay(pdMS_TO_TICKS(Timing::WLED_SYNC_HOLDOFF));
+        }
+    }
+    taskHandle = nullptr;
+    vTaskDelete(nullptr);
+}
+
+bool EffectCatalog::refresh() {
+    char version[VERSION_LENGTH];
+    if (!fetchVersion(version, sizeof(version))) return false;
+
+    const Table& live = current();
+    if (live.source != CatalogSource::BUILTIN && strcmp(live.version, version) == 0) {
+        LOG(CATALOG_CURRENT, live.version, live.effectCount);
+        return true;
+    }
+
+    // Filled while unpublished; a failed attempt simply starts over
+    Table& fresh = spare();
+    clearTable(fresh);
+    strncpy(fresh.version, version, VERSION_LENGTH - 1);
+    if (!fetchNames("/json/eff", fresh, fresh.effects, Effects::MAX_EFFECTS, fresh.effectCount) ||
+        !fetchNames("/json/pal", fresh, fresh.palettes, Effects::MAX_PALETTES, fresh.paletteCount)) {
+        return false;
+    }
+    if (fresh.effectCount == 0) return false;
+
+    fresh.source = CatalogSource::WLED;
+    active.store(&fresh, std::memory_order_release);
+    publishes++;
+    downloads++;
+    save(fresh);
+    LOG(CATALOG_FETCHED, fresh.version, fresh.effectCount, fresh.paletteCount, fresh.poolUsed);
+    return true;
+}
+
+bool EffectCatalog::openBody(HTTPClient& http, WiFiClient& client, const char* path) {
+    // HTTP/1.0 keeps the reply free of chunked encoding, so it can be
+    // scanned straight off the socket
+    http.useHTTP10(true);
+    http.setReuse(false);
+    http.setConnectTimeout(NetworkConfig::WLED_TIMEOUT_MS);
+    http.setTimeout(NetworkConfig::WLED_TIMEOUT_MS);
+    if (!http.begin(client, host, NetworkConfig::WLED_PORT, path)) {
+        LOG(CATALOG_FAILED, path, HTTPC_ERROR_CONNECTION_REFUSED);
+        return false;
+    }
+    const int httpCode = http.GET();
+    if (httpCode != HTTP_CODE_OK) {
+        LOG(CATALOG_FAILED, path, httpCode);
+        http.end();
+        return false;
+    }
+    return true;
+}
+
+// /json/info is a few KB; only "ver" and "vid" are picked out of it
+bool EffectCatalog::fetchVersion(char* version, size_t size) {
+    WiFiClient client;
+    HTTPClient http;
+    if (!openBody(http, client, "/json/info")) return false;
+
+    BodyReader body(http.getStreamPtr(), http.getSize());
+    size_t length = 0;
+    if (body.skipPast("\"ver\":\"")) {
+        int c;
+        while ((c = body.next()) >= 0 && c != '"') {
+            if (length < size - 1) version[length++] = c;
+        }
+    }
+    version[length] = '\0';
+    if (length == 0) {
+        LOG(CATALOG_FAILED, "/json/info", HTTPC_ERROR_NO_STREAM);
+        http.end();
+        return false;
+    }
+
+    // The build number tells apart builds that share a version string
+    if (body.skipPast("\"vid\":")) {
+        int c;
+        if (length < size - 1) version[length++] = '/';
+        while ((c = body.next()) >= '0' && c <= '9') {
+            if (length < size - 1) version[length++] = c;
+        }
+        version[length] = '\0';
+    }
+    http.end();
+    return true;
+}
+
+// Scans a JSON array of strings; each name is interned as it completes
+bool EffectCatalog::fetchNames(const char* path, Table& table, uint16_t* offsets,
+                               size_t capacity, uint16_t& count) {
+    WiFiClient client;
+    HTTPClient http;
+    if (!openBody(http, client, path)) return false;
+
+    BodyReader body(http.getStreamPtr(), http.getSize());
+    bool complete = body.skipPast("[");
+    char name[Effects::MAX_NAME_LENGTH + 1];
+    int c;
+    while (complete && (c = body.next()) != ']') {
+        if (c < 0) {
+            complete = false;
+            break;
+        }
+        if (c != '"') continue;     // Commas and whitespace
+
+        size_t length = 0;
+        bool metadata = false;
+        while ((c = body.next()) >= 0 && c != '"') {
+            if (c == '\\') {
+                c = body.next();
+                if (c == 'u') {
+                    // Not in the display font anyway
+                    for (int digit = 0; digit < 4; digit++) body.next();
+                    c = '?';
+                }
+                if (c < 0) break;
+                if (c == '"' || c == '\\') c = '\'';   // Keeps the name safe to put in JSON
+            }
+            if (c == '@') metadata = true;  // Effect parameters, on builds that include them
+            if (!metadata && length < Effects::MAX_NAME_LENGTH) name[length++] = c;
+        }
+        if (c < 0) {
+            complete = false;
+            break;
+        }
+        name[length] = '\0';
+
+        // IDs past the capacity are dropped and cannot be selected
+        if (count >= capacity) continue;
+        const int offset = intern(table, name);
+        if (offset < 0) {
+            LOG(CATALOG_FAILED, path, HTTPC_ERROR_TOO_LESS_RAM);
+            http.end();
+            return false;
+        }
+        offsets[count++] = offset;
+    }
+    http.end();
+    if (!complete) LOG(CATALOG_FAILED, path, HTTPC_ERROR_CONNECTION_LOST);
+    return complete;
+}
+
+void EffectCatalog::save(const Table& table) {
+    Preferences preferences;
+    if (!preferences.begin(Effects::CACHE_NAMESPACE, false)) return;
+
+    // Without the version a half-written cache is ignored at the next boot
+    preferences.remove("version");
+    bool ok = preferences.putBytes("effects", table.effects, table.effectCount * sizeof(uint16_t)) > 0 &&
+              preferences.putBytes("names", table.pool, table.poolUsed) > 0;
+    if (table.paletteCount > 0) {
+        ok = ok && preferences.putBytes("palettes", table.palettes, table.paletteCount * sizeof(uint16_t)) > 0;
+    } else {
+        preferences.remove("palettes");
+    }
+    if (ok) preferences.putBytes("version", table.version, strlen(table.version) + 1);
+    preferences.end();
+}
+
+void EffectCatalog::clearTable(Table& table) {
+    table.source = CatalogSource::BUILTIN;
+    table.version[0] = '\0';
+    table.version[VERSION_LENGTH - 1] = '\0';
+    table.effectCount = 0;
+    table.paletteCount = 0;
+    table.poolUsed = 0;
+}
+
+// Returns the pool offset of name, adding it if it is not there yet; -1 when full
+int EffectCatalog::intern(Table& table, const char* name) {
+    for (size_t at = 0; at < table.poolUsed; at += strlen(table.pool + at) + 1) {
+        if (strcmp(table.pool + at, name) == 0) return at;
+    }
+    const size_t length = strlen(name) + 1;
+    if (table.poolUsed + length > sizeof(table.pool)) return -1;
+    const int offset = table.poolUsed;
+    memcpy(table.pool + offset, name, length);
+    table.poolUsed += length;
+    return offset;
+}
+
+bool EffectCatalog::reserved(const Table& table, int index) {
+    const char* name = table.pool + table.effects[index];
+    return name[0] == '\0' || strcmp(name, "RSVD") == 0 || strcmp(name, "-") == 0;
+}
+
+// A cache from another layout or a torn write must not index past the pool
+bool EffectCatalog::validTable(const Table& table) {
+    if (table.poolUsed == 0 || table.pool[table.poolUsed - 1] != '\0') return false;
+    for (size_t i = 0; i < table.effectCount; i++) {
+        if (table.effects[i] >= table.poolUsed) return false;
+    }
+    for (size_t i = 0; i < table.paletteCount; i++) {
+        if (table.palettes[i] >= table.poolUsed) return false;
+    }
+    return true;
+}
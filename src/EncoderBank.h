@@ -0,0 +1,159 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <soc/soc.h>
+#include <soc/gpio_reg.h>
+#include "config.h"
+
+// Where a channel's pins sit in the GPIO input registers, worked out at
+// compile time so each handler is a single load, two shifts and a mask
+template <size_t N>
+struct EncoderPins {
+    static constexpr uint8_t PIN_A = Encoders::CHANNELS[N].pinA;
+    static constexpr uint8_t PIN_B = Encoders::CHANNELS[N].pinB;
+    static constexpr uint32_t REGISTER = PIN_A < 32 ? GPIO_IN_REG : GPIO_IN1_REG;
+    static constexpr uint8_t SHIFT_A = PIN_A % 32;
+    static constexpr uint8_t SHIFT_B = PIN_B % 32;
+
+    // One load must see both pins
+    static_assert((PIN_A < 32) == (PIN_B < 32), "Encoder pins must share a GPIO input register");
+    static_assert(PIN_A < 54 && PIN_B < 54, "Encoder pins must be GPIO0-53");
+};
+
+// Quadrature decoding for every row of Encoders::CHANNELS. Each channel
+// gets its own handler, instantiated from a template, on both of its pins.
+// A detent is one full quadrature cycle, ending with both pins high at
+// rest (KY-040). On each detent the handler looks up how far to step from
+// the time since the channel's previous one, so acceleration costs the
+// ISR one subtraction and one table load. The ISRs only accumulate steps;
+// loop() swaps them out with take().
+class EncoderBank {
+public:
+    EncoderBank();
+
+    // Configures the pins, seeds the decoders and attaches the handlers
+    void begin();
+
+    // Accelerated steps per channel since the last call, and micros() of
+    // the oldest detent among them; false if nothing moved
+    bool take(int16_t (&steps)[Encoders::COUNT], uint32_t& oldestUs);
+
+private:
+    // Detent intervals are bucketed by 2 ms; the last bucket holds 126 ms and up
+    static constexpr uint32_t BUCKET_US = 2000;
+    static constexpr size_t BUCKETS = 64;
+    static constexpr uint8_t REST = 0b11;
+
+    std::atomic<bool> event;
+    std::atomic<int16_t> changes[Encoders::COUNT];
+    std::atomic<uint32_t> inputUs;   // 0 if no detent is waiting
+    uint8_t prevStates[Encoders::COUNT];
+    int8_t partial[Encoders::COUNT];            // Quarter steps since the last rest position
+    uint32_t lastDetentUs[Encoders::COUNT];
+    uint8_t stepTable[Encoders::COUNT][BUCKETS];  // In DRAM, like the object, for the ISRs
+
+    // Steps one detent is worth after intervalUs; fills stepTable at begin()
+    static uint8_t accelerate(const Encoders::Acceleration& curve, uint32_t intervalUs);
+    template <size_t N> static void IRAM_ATTR handleEdge(void* param);
+    template <size_t N> void attachFrom();
+    template <size_t N> uint8_t IRAM_ATTR readPins() const;
+    void IRAM_ATTR step(size_t channel, uint8_t pins);
+};
+
+// Ends the attachFrom() recursion past the last channel
+template <>
+void EncoderBank::attachFrom<Encoders::COUNT>() {}
+
+EncoderBank::EncoderBank() :
+    event(false),
+    changes{},
+    inputUs(0),
+    prevStates{},
+    partial{},
+    lastDetentUs{},
+    stepTable{} {}
+
+void EncoderBank::begin() {
+    for (size_t channel = 0; channel < Encoders::COUNT; channel++) {
+        for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+            stepTable[channel][bucket] = accelerate(Encoders::CHANNELS[channel].acceleration, bucket * BUCKET_US);
+        }
+    }
+    for (const Encoders::Channel& channel : Encoders::CHANNELS) {
+        pinMode(channel.pinA, INPUT_PULLUP);
+        pinMode(channel.pinB, INPUT_PULLUP);
+    }
+    attachFrom<0>();
+}
+
+// Start each decoder from the resting pin levels, otherwise the first
+// edge after boot is read as a step in the wrong direction
+template <size_t N>
+void EncoderBank::attachFrom() {
+    prevStates[N] = readPins<N>();
+    attachInterruptArg(EncoderPins<N>::PIN_A, handleEdge<N>, this, CHANGE);
+    attachInterruptArg(EncoderPins<N>::PIN_B, handleEdge<N>, this, CHANGE);
+    attachFrom<N + 1>();
+}
+
+template <size_t N>
+uint8_t IRAM_ATTR EncoderBank::readPins() const {
+    const uint32_t levels = REG_READ(EncoderPins<N>::REGISTER);
+    return (((levels >> EncoderPins<N>::SHIFT_A) & 1) << 1) | ((levels >> EncoderPins<N>::SHIFT_B) & 1);
+}
+
+template <size_t N>
+void IRAM_ATTR EncoderBank::handleEdge(void* param) {
+    EncoderBank* bank = static_cast<EncoderBank*>(param);
+    bank->step(N, bank->readPins<N>());
+}
+
+void IRAM_ATTR EncoderBank::step(size_t channel, uint8_t pins) {
+    static const DRAM_ATTR int8_t encoder_states[] = {0,-1,1,0,1,0,0,-1,-1,0,0,1,0,1,-1,0};
+
+    const uint8_t state = ((prevStates[channel] << 2) & 0x0F) | pins;
+    prevStates[channel] = state;
+
+    const int8_t change = encoder_states[state];
+    if (change == 0) return;
+    partial[channel] += change;
+    if (pins != REST) return;
+
+    // Back at rest: at least half a cycle one way is a detent, which
+    // tolerates a missed edge; less is a wiggle that came back
+    const int8_t quarters = partial[channel];
+    partial[channel] = 0;
+    if (quarters > -2 && quarters < 2) return;
+
+    const uint32_t nowUs = micros();
+    uint32_t bucket = (nowUs - lastDetentUs[channel]) / BUCKET_US;
+    if (bucket >= BUCKETS) bucket = BUCKETS - 1;
+    lastDetentUs[channel] = nowUs;
+    const int16_t steps = stepTable[channel][bucket];
+
+    uint32_t none = 0;
+    inputUs.compare_exchange_strong(none, nowUs, std::memory_order_relaxed);
+    changes[channel].fetch_add(quarters > 0 ? steps : -steps, std::memory_order_relaxed);
+    event.store(true, std::memory_order_release);
+}
+
+bool EncoderBank::take(int16_t (&steps)[Encoders::COUNT], uint32_t& oldestUs) {
+    if (!event.exchange(false, std::memory_order_acquire)) return false;
+
+    // Detents arriving meanwhile land in the fresh counters and re-raise the event
+    for (size_t i = 0; i < Encoders::COUNT; i++) {
+        steps[i] = changes[i].exchange(0, std::memory_order_relaxed);
+    }
+    oldestUs = inputUs.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+uint8_t EncoderBank::accelerate(const Encoders::Acceleration& curve, uint32_t intervalUs) {
+    const float intervalMs = intervalUs / 1000.0f;
+    if (curve.slowMs <= curve.fastMs || intervalMs >= curve.slowMs) return curve.slowStep;
+    if (intervalMs <= curve.fastMs) return curve.fastStep;
+
+    const float speed = (curve.slowMs - intervalMs) / (curve.slowMs - curve.fastMs);  // 0 slow ... 1 fast
+    return static_cast<uint8_t>(curve.slowStep + (curve.fastStep - curve.slowStep) * speed * speed + 0.5f);
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+#include "SpscRing.h"
+
+enum class InputEventType : uint8_t {
+    BUTTON,     // value: ButtonAction
+    ENCODER     // value: signed detent delta
+};
+
+enum class ButtonAction : int16_t {
+    RELEASED = 0,
+    PRESSED = 1,
+    LONG_PRESS = 2,     // Held for Buttons::LONG_PRESS_MS
+    REPEAT = 3          // Every Buttons::REPEAT_INTERVAL_MS after that, until released
+};
+
+struct InputEvent {
+    InputEventType type;
+    uint8_t source;             // Buttons::ID, or encoder index for ENCODER events
+    int16_t value;
+    uint32_t timestampUs;       // micros() of the input (a press: its first sampled edge)
+
+    static InputEvent button(Buttons::ID id, ButtonAction action, uint32_t timestampUs) {
+        return {InputEventType::BUTTON, static_cast<uint8_t>(id), static_cast<int16_t>(action), timestampUs};
+    }
+
+    static InputEvent encoder(uint8_t index, int16_t delta, uint32_t timestampUs) {
+        return {InputEventType::ENCODER, index, delta, timestampUs};
+    }
+
+    Buttons::ID buttonId() const { return static_cast<Buttons::ID>(source); }
+    ButtonAction action() const { return static_cast<ButtonAction>(value); }
+    bool pressed() const { return action() == ButtonAction::PRESSED; }
+};
+
+// Input event queue from the button scan (single producer) to loop() (single consumer)
+class InputEventQueue {
+public:
+    // Plain copy of the counters for printing
+    struct DebugInfo {
+        uint32_t pushAttempts;
+        uint32_t pushSuccess;
+        uint32_t overflows;
+        uint32_t popAttempts;
+        uint32_t popSuccess;
+        uint8_t lastPushedSource;
+        uint8_t lastProcessedSource;
+        uint32_t interruptCalls;
+        uint32_t debounceChecks;
+    };
+
+    // Producer side (button scan)
+    bool push(const InputEvent& event) {
+        pushAttempts.fetch_add(1, std::memory_order_relaxed);
+        if (!ring.push(event)) return false;
+        pushSuccess.fetch_add(1, std::memory_order_relaxed);
+        lastPushedSource.store(event.source, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Consumer side (loop)
+    bool pop(InputEvent& event) {
+        popAttempts.fetch_add(1, std::memory_order_relaxed);
+        if (!ring.pop(event)) return false;
+        popSuccess.fetch_add(1, std::memory_order_relaxed);
+        lastProcessedSource.store(event.source, std::memory_order_relaxed);
+        return true;
+    }
+
+    // One button scan, and how many of its buttons were still settling
+    void countScan(uint32_t checks) {
+        interruptCalls.fetch_add(1, std::memory_order_relaxed);
+        debounceChecks.fetch_add(checks, std::memory_order_relaxed);
+    }
+
+    size_t getSize() const { return ring.size(); }
+
+    DebugInfo getDebugInfo() const {
+        return {
+            pushAttempts.load(std::memory_order_relaxed),
+            pushSuccess.load(std::memory_order_relaxed),
+            ring.getOverflows(),
+            popAttempts.load(std::memory_order_relaxed),
+            popSuccess.load(std::memory_order_relaxed),
+            lastPushedSource.load(std::memory_order_relaxed),
+            lastProcessedSource.load(std::memory_order_relaxed),
+            interruptCalls.load(std::memory_order_relaxed),
+            debounceChecks.load(std::memory_order_relaxed)
+        };
+    }
+
+private:
+    static constexpr size_t SIZE = 32;
+    SpscRing<InputEvent, SIZE> ring;
+
+    // Each counter has a single writer: producer-side ones are only touched
+    // by the button scan, consumer-side ones only by loop()
+    std::atomic<uint32_t> pushAttempts{0};
+    std::atomic<uint32_t> pushSuccess{0};
+    std::atomic<uint8_t> lastPushedSource{0};
+    std::atomic<uint32_t> popAttempts{0};
+    std::atomic<uint32_t> popSuccess{0};
+    std::atomic<uint8_t> lastProcessedSource{0};
+    std::atomic<uint32_t> interruptCalls{0};
+    std::atomic<uint32_t> debounceChecks{0};
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+
+// Fixed-bucket latency histogram in microseconds. Recording is O(buckets)
+// with no allocation, so it is cheap enough for the network tasks; any
+// task may record or read.
+class LatencyHistogram {
+public:
+    // Upper bucket bounds; anything slower lands in the overflow bucket
+    static constexpr uint32_t BOUNDS_US[] = {
+        250, 500, 1000, 2000, 3000, 5000, 7500, 10000, 15000, 20000, 30000,
+        50000, 75000, 100000, 150000, 200000, 300000, 500000, 750000, 1000000, 2000000
+    };
+    static constexpr size_t BUCKET_COUNT = sizeof(BOUNDS_US) / sizeof(BOUNDS_US[0]) + 1;
+
+    // Plain copy for reporting
+    struct Summary {
+        uint32_t count;
+        uint32_t minUs;
+        uint32_t maxUs;
+        uint32_t averageUs;
+        uint32_t p50Us;     // Percentiles are bucket upper bounds
+        uint32_t p95Us;
+        uint32_t p99Us;
+    };
+
+    void record(uint32_t latencyUs);
+    Summary summarize();
+    void reset();
+
+private:
+    uint32_t buckets[BUCKET_COUNT] = {};
+    uint32_t count = 0;
+    uint64_t totalUs = 0;
+    uint32_t minUs = UINT32_MAX;
+    uint32_t maxUs = 0;
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+    uint32_t percentile(uint32_t permille) const;
+};
+
+// Stages between an input edge and WLED acknowledging the change
+struct LatencyMetrics {
+    LatencyHistogram inputToQueue;  // ISR timestamp -> handed to the WLED target (loop() delay)
+    LatencyHistogram queueToSend;   // Waiting for the pacer and the network task
+    LatencyHistogram network;       // HTTP round trip, or UDP send for realtime frames
+    LatencyHistogram endToEnd;      // ISR timestamp -> HTTP response / UDP frame sent
+};
+
+constexpr uint32_t LatencyHistogram::BOUNDS_US[];
+
+void LatencyHistogram::record(uint32_t latencyUs) {
+    size_t bucket = 0;
+    while (bucket < BUCKET_COUNT - 1 && latencyUs > BOUNDS_US[bucket]) bucket++;
+
+    portENTER_CRITICAL(&lock);
+    buckets[bucket]++;
+    count++;
+    totalUs += latencyUs;
+    if (latencyUs < minUs) minUs = latencyUs;
+    if (latencyUs > maxUs) maxUs = latencyUs;
+    portEXIT_CRITICAL(&lock);
+}
+
+LatencyHistogram::Summary LatencyHistogram::summarize() {
+    portENTER_CRITICAL(&lock);
+    Summary summary{
+        count,
+        count ? minUs : 0,
+        maxUs,
+        count ? static_cast<uint32_t>(totalUs / count) : 0,
+        percentile(500),
+        percentile(950),
+        percentile(990)
+    };
+    portEXIT_CRITICAL(&lock);
+    return summary;
+}
+
+void LatencyHistogram::reset() {
+    portENTER_CRITICAL(&lock);
+    memset(buckets, 0, sizeof(buckets));
+    count = 0;
+    totalUs = 0;
+    minUs = UINT32_MAX;
+    maxUs = 0;
+    portEXIT_CRITICAL(&lock);
+}
+
+// Caller holds lock
+uint32_t LatencyHistogram::percentile(uint32_t permille) const {
+    if (count == 0) return 0;
+    // Rank of the sample at this percentile, 1-based and rounded up
+    const uint32_t rank = (static_cast<uint64_t>(count) * permille + 999) / 1000;
+    uint32_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            // The overflow bucket has no bound; the true maximum is the best answer
+            return i < BUCKET_COUNT - 1 ? min(BOUNDS_US[i], maxUs) : maxUs;
+        }
+    }
+    return maxUs;
+}
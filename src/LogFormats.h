@@ -0,0 +1,69 @@
+#pragma once
+
+#include <inttypes.h>
+
+// Format strings for the binary log. Call sites record only the ID and
+// raw arguments; the text lives here and is formatted by the drain task.
+// uint32_t arguments print through PRIu32, size_t through %zu.
+// %s arguments must point at strings that outlive the record (literals,
+// config tables), never at temporary buffers.
+#define LOG_FORMATS(X) \
+    X(COLOR_CHANGE,     "Color changing from R:%d G:%d B:%d to R:%d G:%d B:%d\n") \
+    X(COLOR_UPDATE,     "Color Update - R:%d G:%d B:%d\n") \
+    X(BUTTON_PRESS,     "Processing button %d press\n") \
+    X(BUTTON_HOLD,      "Button %d %s\n") \
+    X(COLOR_MODE,       "Color mode: %s\n") \
+    X(WLED_SEND_COLOR,  "Sending WLED update - R:%d G:%d B:%d\n") \
+    X(WLED_SEND_EFFECT, "Sending WLED effect update: %s\n") \
+    X(WLED_OK,          "WLED %s update [%s%s%s ]: HTTP %d in %lu ms, %" PRIu32 " us from input\n") \
+    X(WLED_FAILED,      "WLED %s update [%s%s%s ] failed - Error %d (%lu ms)\n") \
+    X(STORE_COMMIT,     "State #%" PRIu32 " saved to slot %" PRIu32 " - R:%d G:%d B:%d Effect:%d Brightness:%d\n") \
+    X(STORE_FAILED,     "State save to slot %" PRIu32 " failed\n") \
+    X(DISPLAY_UPDATE,   "Display Update #%lu - %s %d/%d/%d, %zu I2C bytes (full frame ~%zu)\n") \
+    X(API_REQUEST,      "API Request from %u.%u.%u.%u\n") \
+    X(WIFI_CONNECTED,   "WiFi connected - IP %u.%u.%u.%u, %lu ms since boot\n") \
+    X(WIFI_LOST,        "WiFi connection lost (reason %u)\n") \
+    X(WIFI_FAILED,      "WiFi attempt failed after %lu ms (reason %u)\n") \
+    X(WIFI_BACKOFF,     "WiFi retry in %lu ms\n") \
+    X(WLED_SYNC_UP,     "WLED sync connected\n") \
+    X(WLED_SYNC_DOWN,   "WLED sync disconnected\n") \
+    X(WLED_SYNC_BAD,    "WLED sync - unreadable push (%zu bytes)\n") \
+    X(CATALOG_CURRENT,  "Effect catalog %s is current (%u effects), no download\n") \
+    X(CATALOG_FETCHED,  "Effect catalog %s fetched - %u effects, %u palettes, %u bytes of names\n") \
+    X(CATALOG_FAILED,   "Effect catalog - %s failed (%d)\n") \
+    X(WLED_SYNC_APPLY,  "WLED sync - R:%d G:%d B:%d Effect:%d Brightness:%d\n") \
+    X(DEBUG_HEADER,     "\n----- DEBUG INFO -----\n") \
+    X(DEBUG_QUEUE_PUSH, "Queue - Push attempts: %" PRIu32 ", Success: %" PRIu32 "\n") \
+    X(DEBUG_QUEUE_POP,  "Queue - Pop attempts: %" PRIu32 ", Success: %" PRIu32 ", Overflows: %" PRIu32 "\n") \
+    X(DEBUG_SOURCES,    "Last source - Pushed: %u, Processed: %u\n") \
+    X(DEBUG_INTERRUPTS, "Interrupts: %" PRIu32 ", Debounce checks: %" PRIu32 "\n") \
+    X(DEBUG_BUTTONS,    "Button scan - Avg: %" PRIu32 " ns, Max: %" PRIu32 " us, Total: %" PRIu32 " us; %" PRIu32 " edges, ~%" PRIu32 " us of edge ISRs\n") \
+    X(DEBUG_VALUES,     "Current Values - R:%d G:%d B:%d Effect:%d Mode:%s\n") \
+    X(DEBUG_DISPLAY,    "Display - Frames published: %" PRIu32 ", Dropped: %" PRIu32 ", I2C bytes: %" PRIu32 "\n") \
+    X(DEBUG_WLED,       "WLED %s - %s, Failures in a row: %" PRIu32 "\n") \
+    X(DEBUG_WLED_CONN,  "  Requests: %" PRIu32 ", Reused: %" PRIu32 ", Reconnects: %" PRIu32 ", Retries: %" PRIu32 "\n") \
+    X(DEBUG_WLED_TIME,  "  Avg reused: %lu ms, Avg fresh: %lu ms, Realtime frames: %" PRIu32 "\n") \
+    X(DEBUG_WLED_PACE,  "  Coalesced: %" PRIu32 ", Avg round trip: %lu ms, Send interval: %lu ms\n") \
+    X(DEBUG_WLED_SWEEP, "  Sweeps: %" PRIu32 ", Requests: %" PRIu32 " (%lu.%lu per sweep), Time: %lu ms\n") \
+    X(DEBUG_WLED_SYNC,  "WLED sync - %s, Pushes: %" PRIu32 ", Applied: %" PRIu32 "\n") \
+    X(DEBUG_WIFI,       "WiFi - %s, Reconnects: %" PRIu32 ", Retry delay: %lu ms\n") \
+    X(DEBUG_CATALOG,    "Effects - %s catalog %s, %u effects, %u palettes\n") \
+    X(DEBUG_STORE,      "Store - Writes: %" PRIu32 " (last hour: %" PRIu32 "), Failed: %" PRIu32 ", Record #%" PRIu32 "\n") \
+    X(DEBUG_LATENCY,    "Input to WLED - Samples: %" PRIu32 ", p50: %" PRIu32 " us, p95: %" PRIu32 " us, p99: %" PRIu32 " us, Max: %" PRIu32 " us\n") \
+    X(DEBUG_LOOP,       "Loop - %" PRIu32 " Hz, Avg: %" PRIu32 " us, Max: %" PRIu32 " us, Over %lu us budget: %" PRIu32 "\n") \
+    X(DEBUG_LOOP_STAGE, "  %-12s Min: %" PRIu32 " us, Avg: %" PRIu32 " us, Max: %" PRIu32 " us, Overruns: %" PRIu32 "\n") \
+    X(DEBUG_FOOTER,     "--------------------\n\n")
+
+// The same texts by ID, for the drain task and for LOG()'s format check
+namespace LogText {
+#define LOG_FORMAT_TEXT(id, text) constexpr char id[] = text;
+    LOG_FORMATS(LOG_FORMAT_TEXT)
+#undef LOG_FORMAT_TEXT
+}
+
+enum class LogFormat : uint16_t {
+#define LOG_FORMAT_ID(id, text) id,
+    LOG_FORMATS(LOG_FORMAT_ID)
+#undef LOG_FORMAT_ID
+    COUNT
+};
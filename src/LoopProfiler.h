@@ -0,0 +1,159 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+#include "SeqLock.h"
+
+// Stages of one loop() iteration, in order
+enum class LoopStage : uint8_t {
+    ENCODERS,
+    BUTTONS,
+    NETWORK,
+    WLED_RESULTS,
+    REMOTE_STATE,
+    DEBUG_INFO,
+    DISPLAY,
+    WLED_SEND,
+    COUNT
+};
+
+// Cycle-counter profiler for loop(). Each stage is timed from the end of
+// the previous one, so the stages add up to the whole iteration. Samples
+// accumulate over a window of Profiling::REPORT_INTERVAL and are then
+// published as a report any task can read.
+class LoopProfiler {
+public:
+    static constexpr size_t STAGE_COUNT = static_cast<size_t>(LoopStage::COUNT);
+
+    struct StageReport {
+        uint32_t minUs;
+        uint32_t maxUs;
+        uint32_t averageUs;
+        uint32_t overruns;      // Samples over budget in this window
+    };
+
+    struct Report {
+        StageReport stages[STAGE_COUNT];
+        StageReport loop;       // Whole iteration, against Profiling::LOOP_BUDGET_US
+        uint32_t iterations;
+        uint32_t loopHz;
+    };
+
+    LoopProfiler();
+    void begin();
+
+    // loop() only
+    void startLoop();
+    void endStage(LoopStage stage);
+    void endLoop();
+
+    Report getReport(uint32_t* version = nullptr) const { return report.read(version); }
+    static const char* stageName(size_t stage);
+
+private:
+    struct Accumulator {
+        uint32_t minCycles;
+        uint32_t maxCycles;
+        uint64_t totalCycles;
+        uint32_t samples;
+        uint32_t overruns;
+    };
+
+    Accumulator stages[STAGE_COUNT];
+    Accumulator loop;
+    uint32_t cyclesPerUs;
+    uint32_t stageBudgetCycles;
+    uint32_t loopBudgetCycles;
+    uint32_t loopStartCycles;
+    uint32_t lastMarkCycles;
+    unsigned long windowStartMs;
+    SeqLock<Report> report;
+
+    static void add(Accumulator& acc, uint32_t cycles, uint32_t budgetCycles);
+    StageReport toReport(const Accumulator& acc) const;
+    void publish(unsigned long now);
+    void resetWindow(unsigned long now);
+};
+
+LoopProfiler::LoopProfiler() :
+    cyclesPerUs(1),
+    stageBudgetCycles(0),
+    loopBudgetCycles(0),
+    loopStartCycles(0),
+    lastMarkCycles(0),
+    windowStartMs(0),
+    report(Report{}) {
+    resetWindow(0);
+}
+
+void LoopProfiler::begin() {
+    cyclesPerUs = ESP.getCpuFreqMHz();
+    stageBudgetCycles = Profiling::STAGE_BUDGET_US * cyclesPerUs;
+    loopBudgetCycles = Profiling::LOOP_BUDGET_US * cyclesPerUs;
+    resetWindow(millis());
+}
+
+void LoopProfiler::startLoop() {
+    loopStartCycles = lastMarkCycles = ESP.getCycleCount();
+}
+
+void LoopProfiler::endStage(LoopStage stage) {
+    uint32_t now = ESP.getCycleCount();
+    add(stages[static_cast<size_t>(stage)], now - lastMarkCycles, stageBudgetCycles);
+    lastMarkCycles = now;
+}
+
+void LoopProfiler::endLoop() {
+    add(loop, ESP.getCycleCount() - loopStartCycles, loopBudgetCycles);
+
+    unsigned long now = millis();
+    if (now - windowStartMs >= Profiling::REPORT_INTERVAL) {
+        publish(now);
+        resetWindow(now);
+    }
+}
+
+const char* LoopProfiler::stageName(size_t stage) {
+    static const char* const NAMES[STAGE_COUNT] = {
+        "encoders", "buttons", "network", "wled_results", "remote_state", "debug_info", "display", "wled_send"
+    };
+    return stage < STAGE_COUNT ? NAMES[stage] : "?";
+}
+
+// Cycle differences stay correct across the 32-bit counter wrapping
+void LoopProfiler::add(Accumulator& acc, uint32_t cycles, uint32_t budgetCycles) {
+    if (cycles < acc.minCycles) acc.minCycles = cycles;
+    if (cycles > acc.maxCycles) acc.maxCycles = cycles;
+    acc.totalCycles += cycles;
+    acc.samples++;
+    if (cycles > budgetCycles) acc.overruns++;
+}
+
+LoopProfiler::StageReport LoopProfiler::toReport(const Accumulator& acc) const {
+    if (acc.samples == 0) return StageReport{0, 0, 0, 0};
+    return StageReport{
+        acc.minCycles / cyclesPerUs,
+        acc.maxCycles / cyclesPerUs,
+        static_cast<uint32_t>(acc.totalCycles / acc.samples / cyclesPerUs),
+        acc.overruns
+    };
+}
+
+void LoopProfiler::publish(unsigned long now) {
+    Report next;
+    for (size_t i = 0; i < STAGE_COUNT; i++) {
+        next.stages[i] = toReport(stages[i]);
+    }
+    next.loop = toReport(loop);
+    next.iterations = loop.samples;
+    unsigned long elapsed = now - windowStartMs;
+    next.loopHz = elapsed ? static_cast<uint32_t>(static_cast<uint64_t>(loop.samples) * 1000 / elapsed) : 0;
+    report.write(next);
+}
+
+void LoopProfiler::resetWindow(unsigned long now) {
+    const Accumulator empty{UINT32_MAX, 0, 0, 0, 0};
+    for (auto& acc : stages) acc = empty;
+    loop = empty;
+    windowStartMs = now;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// Bounded lock-free multi-producer/single-consumer ring. Any task or ISR
+// may push; one consumer pops. Each slot carries a sequence number that
+// says whether it is free for the producer at a given position or holds
+// an item for the consumer, so producers only contend on the head index.
+template <typename T, size_t Capacity>
+class MpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "MpscRing capacity must be a power of two");
+
+public:
+    MpscRing() {
+        for (uint32_t i = 0; i < Capacity; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Any producer. Returns false (and counts an overflow) when full.
+    bool push(const T& item) {
+        uint32_t position = head.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots[position & MASK];
+            const int32_t lag = static_cast<int32_t>(
+                slot->sequence.load(std::memory_order_acquire) - position);
+            if (lag == 0) {
+                // Slot is free at this position; claim it
+                if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (lag < 0) {
+                overflows.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                position = head.load(std::memory_order_relaxed);  // Another producer got there first
+            }
+        }
+        slot->item = item;
+        slot->sequence.store(position + 1, std::memory_order_release);  // Publish to the consumer
+        return true;
+    }
+
+    // Consumer side. Returns false when empty, or when the oldest claimed
+    // slot is still being written.
+    bool pop(T& item) {
+        const uint32_t position = tail.load(std::memory_order_relaxed);
+        Slot& slot = slots[position & MASK];
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+            return false;
+        }
+        item = slot.item;
+        slot.sequence.store(position + Capacity, std::memory_order_release);  // Free for the next lap
+        tail.store(position + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+    uint32_t getOverflows() const { return overflows.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t MASK = Capacity - 1;
+
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        T item;
+    };
+
+    Slot slots[Capacity];
+    std::atomic<uint32_t> head{0};  // Next position to claim, shared by producers
+    std::atomic<uint32_t> tail{0};  // Written only by the consumer
+    std::atomic<uint32_t> overflows{0};
+};
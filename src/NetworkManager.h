@@ -3,33 +3,147 @@
 #include <WiFi.h>
 #include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
+#include <atomic>
 #include "config.h"
 #include "StateManager.h"
+#include "LatencyHistogram.h"
+#include "LoopProfiler.h"
+#include "StateStore.h"
+#include "EffectCatalog.h"
+#include "ButtonScanner.h"
+#include "WLEDController.h"
+#include "BinaryLog.h"
+
+// Wi-Fi link as seen by loop()
+enum class LinkState : uint8_t {
+    CONNECTING,     // Association attempt in progress
+    CONNECTED,
+    BACKOFF         // Waiting to retry; the delay doubles with every failed attempt
+};
 
 class NetworkManager {
 public:
     NetworkManager();
+    // Non-blocking: configures the station and starts the first attempt
     bool begin();
-    void setupWebServer(StateManager& stateManager);  
+
+    // Drives the Wi-Fi state machine from loop(). Returns true once each
+    // time the link comes up, so the caller can re-send what WLED missed.
+    bool service();
+    bool isConnected() const { return linkState == LinkState::CONNECTED; }
+    LinkState getLinkState() const { return linkState; }
+    uint32_t getReconnects() const { return reconnects; }
+    unsigned long getRetryDelayMs() const { return retryDelayMs; }
+
+    void setupWebServer(StateManager& stateManager, LatencyMetrics& latency, LoopProfiler& profiler,
+                        StateStore& stateStore, const EffectCatalog& catalog, ButtonScanner& buttonScanner,
+                        WLEDController& wled);
+
+    // Push what changed since the last call to /api/events clients (loop(),
+    // once per display frame so fast knob turns are batched)
+    void streamState();
 
 private:
     AsyncWebServer server;
+    AsyncEventSource events;
     StateManager* stateManagerPtr; 
+    LatencyMetrics* latencyPtr;
+    LoopProfiler* profilerPtr;
+    StateStore* stateStorePtr;
+    const EffectCatalog* catalogPtr;
+    ButtonScanner* buttonScannerPtr;
+    WLEDController* wledPtr;
+    StateSnapshot lastStreamed;
+    uint32_t lastStreamedVersion;
+
+    // Set by the Wi-Fi event task, consumed by service()
+    std::atomic<bool> gotIp;
+    std::atomic<bool> linkLost;
+    std::atomic<uint8_t> disconnectReason;
+
+    // Owned by loop()
+    LinkState linkState;
+    unsigned long stateSinceMs;
+    unsigned long retryDelayMs;     // 0 until an attempt has failed
+    uint32_t reconnects;            // Times the link came back after being up
+    bool everConnected;
+
+    // /api/status body for one state version and effect catalog; only
+    // touched by the async web task, which runs every handler
+    char statusBody[192];
+    size_t statusLength;
+    char statusETag[40];
+    uint32_t statusVersion;
+    uint32_t statusCatalog;
+    bool statusValid;
+
     bool setupWiFi();
+    void startConnect(unsigned long now);
+    void enterBackoff(unsigned long now);
+    void refreshStatus();
+    size_t formatState(char* buffer, size_t size, const StateSnapshot& state,
+                              const StateSnapshot* previous);
+    static void addLatencySummary(JsonObject out, LatencyHistogram& histogram);
+    static void addStageReport(JsonObject out, const LoopProfiler::StageReport& stage);
 };
 
-NetworkManager::NetworkManager() : server(80), stateManagerPtr(nullptr) {}
+NetworkManager::NetworkManager() :
+    server(80),
+    events("/api/events"),
+    stateManagerPtr(nullptr),
+    latencyPtr(nullptr),
+    profilerPtr(nullptr),
+    stateStorePtr(nullptr),
+    catalogPtr(nullptr),
+    buttonScannerPtr(nullptr),
+    wledPtr(nullptr),
+    lastStreamed{},
+    lastStreamedVersion(0),
+    gotIp(false),
+    linkLost(false),
+    disconnectReason(0),
+    linkState(LinkState::CONNECTING),
+    stateSinceMs(0),
+    retryDelayMs(0),
+    reconnects(0),
+    everConnected(false),
+    statusLength(0),
+    statusVersion(0),
+    statusCatalog(0),
+    statusValid(false) {
+    statusBody[0] = '\0';
+    statusETag[0] = '\0';
+}
+
+void NetworkManager::addLatencySummary(JsonObject out, LatencyHistogram& histogram) {
+    const auto summary = histogram.summarize();
+    out["count"] = summary.count;
+    out["min_us"] = summary.minUs;
+    out["avg_us"] = summary.averageUs;
+    out["p50_us"] = summary.p50Us;
+    out["p95_us"] = summary.p95Us;
+    out["p99_us"] = summary.p99Us;
+    out["max_us"] = summary.maxUs;
+}
+
+void NetworkManager::addStageReport(JsonObject out, const LoopProfiler::StageReport& stage) {
+    out["min_us"] = stage.minUs;
+    out["avg_us"] = stage.averageUs;
+    out["max_us"] = stage.maxUs;
+    out["overruns"] = stage.overruns;
+}
 
 bool NetworkManager::begin() {
     return setupWiFi();
 }
 
 bool NetworkManager::setupWiFi() {
-    DEBUG_PRINTLN("\nConnecting to WiFi...");
+    DEBUG_PRINTLN("\nConnecting to WiFi in the background...");
     DEBUG_PRINTF("SSID: %s\n", NetworkConfig::WIFI_SSID);
     DEBUG_PRINTF("Static IP: %s\n", NetworkConfig::STATIC_IP);
     
     WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(false);  // service() retries with its own backoff
     
     // Configure static IP
     IPAddress local_ip;
@@ -44,42 +158,281 @@ bool NetworkManager::setupWiFi() {
         return false;
     }
     
-    WiFi.begin(NetworkConfig::WIFI_SSID, NetworkConfig::WIFI_PASSWORD);
-    
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-        delay(500);
-        DEBUG_PRINT(".");
-        attempts++;
-    }
-    
-    if (WiFi.status() == WL_CONNECTED) {
-        DEBUG_PRINTLN("\nWiFi connected successfully!");
-        DEBUG_PRINT("IP address: ");
-        DEBUG_PRINTLN(WiFi.localIP());
-        return true;
+    // Runs on the Wi-Fi event task; loop() picks the flags up in service()
+    WiFi.onEvent([this](WiFiEvent_t event, WiFiEventInfo_t info) {
+        if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+            gotIp = true;
+        } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+            disconnectReason = info.wifi_sta_disconnected.reason;
+            linkLost = true;
+        }
+    });
+
+    startConnect(millis());
+    return true;
+}
+
+bool NetworkManager::service() {
+    const unsigned long now = millis();
+    switch (linkState) {
+        case LinkState::CONNECTING:
+            if (gotIp.exchange(false)) break;
+            if (linkLost.exchange(false) || now - stateSinceMs >= NetworkConfig::WIFI_CONNECT_TIMEOUT_MS) {
+                LOG(WIFI_FAILED, now - stateSinceMs, disconnectReason.load());
+                enterBackoff(now);
+            }
+            return false;
+
+        case LinkState::CONNECTED:
+            gotIp = false;
+            if (linkLost.exchange(false)) {
+                LOG(WIFI_LOST, disconnectReason.load());
+                enterBackoff(now);
+            }
+            return false;
+
+        case LinkState::BACKOFF:
+            if (gotIp.exchange(false)) break;   // Came back on its own
+            if (now - stateSinceMs >= retryDelayMs) startConnect(now);
+            return false;
     }
-    
-    DEBUG_PRINTLN("\nWiFi connection failed!");
-    return false;
+
+    // Link is up
+    linkLost = false;
+    if (everConnected) reconnects++;
+    everConnected = true;
+    linkState = LinkState::CONNECTED;
+    stateSinceMs = now;
+    retryDelayMs = 0;
+    const IPAddress ip = WiFi.localIP();
+    LOG(WIFI_CONNECTED, ip[0], ip[1], ip[2], ip[3], now);
+    return true;
+}
+
+void NetworkManager::startConnect(unsigned long now) {
+    linkLost = false;
+    WiFi.begin(NetworkConfig::WIFI_SSID, NetworkConfig::WIFI_PASSWORD);
+    linkState = LinkState::CONNECTING;
+    stateSinceMs = now;
 }
 
-void NetworkManager::setupWebServer(StateManager& stateManager) {
+void NetworkManager::enterBackoff(unsigned long now) {
+    retryDelayMs = retryDelayMs == 0 ? NetworkConfig::WIFI_RETRY_MIN_MS
+                                     : min(retryDelayMs * 2, NetworkConfig::WIFI_RETRY_MAX_MS);
+    linkState = LinkState::BACKOFF;
+    stateSinceMs = now;
+    LOG(WIFI_BACKOFF, retryDelayMs);
+}
+
+void NetworkManager::setupWebServer(StateManager& stateManager, LatencyMetrics& latency, LoopProfiler& profiler,
+                                    StateStore& stateStore, const EffectCatalog& catalog,
+                                    ButtonScanner& buttonScanner, WLEDController& wled) {
     stateManagerPtr = &stateManager;  // Store the reference
+    latencyPtr = &latency;
+    profilerPtr = &profiler;
+    stateStorePtr = &stateStore;
+    catalogPtr = &catalog;
+    buttonScannerPtr = &buttonScanner;
+    wledPtr = &wled;
     server.on("/api/status", HTTP_GET, [this](AsyncWebServerRequest *request) {
-        DEBUG_PRINTF("API Request from %s\n", request->client()->remoteIP().toString().c_str());
-        JsonDocument doc; 
-        const auto& color = stateManagerPtr->getColorState();
-        doc["red"] = color.red;
-        doc["green"] = color.green;
-        doc["blue"] = color.blue;
-        doc["effect"] = Effects::NAMES[stateManagerPtr->getEffectIndex()];
-        doc["effect_index"] = stateManagerPtr->getEffectIndex();
-        
+        const IPAddress remote = request->client()->remoteIP();
+        LOG(API_REQUEST, remote[0], remote[1], remote[2], remote[3]);
+        refreshStatus();
+
+        // Pollers that already hold this version get an empty 304
+        if (request->hasHeader("If-None-Match") &&
+            request->getHeader("If-None-Match")->value() == statusETag) {
+            AsyncWebServerResponse *response = request->beginResponse(304);
+            response->addHeader("ETag", statusETag);
+            request->send(response);
+            return;
+        }
+
+        // Served straight from statusBody; the body is far smaller than one
+        // TCP segment, so it is copied out before any later rebuild
+        AsyncWebServerResponse *response = request->beginResponse_P(
+            200, "application/json", reinterpret_cast<const uint8_t*>(statusBody), statusLength);
+        response->addHeader("ETag", statusETag);
+        response->addHeader("Cache-Control", "no-cache");
+        request->send(response);
+    });
+
+    // Input-to-light latency per stage (accumulated since boot), the loop() profile,
+    // the button scan's cost, requests per WLED target and per knob sweep,
+    // flash wear from state saves and where the effect names came from
+    server.on("/api/metrics", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        JsonDocument doc;
+        JsonObject latency = doc["latency"].to<JsonObject>();
+        addLatencySummary(latency["end_to_end"].to<JsonObject>(), latencyPtr->endToEnd);
+        addLatencySummary(latency["input_to_queue"].to<JsonObject>(), latencyPtr->inputToQueue);
+        addLatencySummary(latency["queue_to_send"].to<JsonObject>(), latencyPtr->queueToSend);
+        addLatencySummary(latency["network"].to<JsonObject>(), latencyPtr->network);
+
+        // Last completed profiling window of loop()
+        const auto profile = profilerPtr->getReport();
+        JsonObject loop = doc["loop"].to<JsonObject>();
+        loop["hz"] = profile.loopHz;
+        loop["iterations"] = profile.iterations;
+        loop["budget_us"] = Profiling::LOOP_BUDGET_US;
+        addStageReport(loop["total"].to<JsonObject>(), profile.loop);
+        JsonObject stages = loop["stages"].to<JsonObject>();
+        for (size_t i = 0; i < LoopProfiler::STAGE_COUNT; i++) {
+            addStageReport(stages[LoopProfiler::stageName(i)].to<JsonObject>(), profile.stages[i]);
+        }
+
+        const auto scan = buttonScannerPtr->getStats();
+        JsonObject buttons = doc["buttons"].to<JsonObject>();
+        buttons["scans"] = scan.scans;
+        buttons["scan_avg_ns"] = scan.averageScanNs;
+        buttons["scan_max_us"] = scan.maxScanUs;
+        buttons["scan_time_us"] = scan.scanTimeUs;
+        buttons["edges"] = scan.edges;
+        buttons["edge_isr_estimate_us"] = scan.edgeIsrEstimateUs;
+        buttons["presses"] = scan.presses;
+        buttons["long_presses"] = scan.longPresses;
+        buttons["repeats"] = scan.repeats;
+
+        JsonArray targets = doc["wled"].to<JsonArray>();
+        for (size_t i = 0; i < wledPtr->getTargetCount(); i++) {
+            const auto connection = wledPtr->getConnectionStats(i);
+            JsonObject target = targets.add<JsonObject>();
+            target["address"] = wledPtr->getTargetAddress(i);
+            target["requests"] = connection.requests;
+            target["coalesced"] = connection.coalesced;
+            target["sweeps"] = connection.sweeps;
+            target["sweep_requests"] = connection.sweepRequests;
+            target["requests_per_sweep"] = connection.sweeps ?
+                static_cast<float>(connection.sweepRequests) / connection.sweeps : 0.0f;
+            target["sweep_ms"] = connection.sweepTimeMs;
+        }
+
+        JsonObject wifi = doc["wifi"].to<JsonObject>();
+        wifi["connected"] = isConnected();
+        wifi["reconnects"] = reconnects;
+        wifi["retry_ms"] = retryDelayMs;
+
+        JsonObject storage = doc["storage"].to<JsonObject>();
+        storage["restored"] = stateStorePtr->wasRestored();
+        storage["writes"] = stateStorePtr->getWrites();
+        storage["writes_last_hour"] = stateStorePtr->getWritesLastHour();
+        storage["failed_writes"] = stateStorePtr->getFailedWrites();
+        storage["record"] = stateStorePtr->getSequence();
+
+        JsonObject catalog = doc["catalog"].to<JsonObject>();
+        catalog["source"] = catalogPtr->getSourceName();
+        catalog["version"] = catalogPtr->getVersion();
+        catalog["effects"] = catalogPtr->getEffectCount();
+        catalog["palettes"] = catalogPtr->getPaletteCount();
+        catalog["name_bytes"] = catalogPtr->getPoolBytes();
+        catalog["downloads"] = catalogPtr->getDownloads();
+
         String response;
         serializeJson(doc, response);
         request->send(200, "application/json", response);
     });
+    // State stream: the full state on connect, then deltas from streamState()
+    events.onConnect([this](AsyncEventSourceClient *client) {
+        uint32_t version;
+        const auto state = stateManagerPtr->getSnapshot(&version);
+        char message[224];
+        if (events.count() > NetworkConfig::MAX_EVENT_CLIENTS) {
+            // Tell the browser to back off before it reconnects
+            client->send("too many clients", "error", 0, NetworkConfig::EVENT_FULL_RETRY_MS);
+            client->close();
+            return;
+        }
+        formatState(message, sizeof(message), state, nullptr);
+        client->send(message, "state", version, NetworkConfig::EVENT_RETRY_MS);
+    });
+    server.addHandler(&events);
+
     DEBUG_PRINTLN("Web server routes configured");
     server.begin();
+}
+
+// Re-serializes the status body only when the state version has moved on,
+// or a new catalog may have renamed the effect
+void NetworkManager::refreshStatus() {
+    uint32_t version;
+    // Runs on the async TCP task, so read the published snapshot
+    const auto state = stateManagerPtr->getSnapshot(&version);
+    // Read before the name: a table published in between only costs a rebuild
+    const uint32_t catalog = catalogPtr->getPublishCount();
+    if (statusValid && version == statusVersion && catalog == statusCatalog) return;
+
+    JsonDocument doc;
+    doc["red"] = state.color.red;
+    doc["green"] = state.color.green;
+    doc["blue"] = state.color.blue;
+    doc["effect"] = catalogPtr->getEffectName(state.effectIndex);
+    doc["effect_index"] = state.effectIndex;
+    doc["mode"] = ColorModel::modeName(state.colorMode);
+    JsonArray knobs = doc["knobs"].to<JsonArray>();
+    for (uint8_t knob : state.knobs) knobs.add(knob);
+    statusLength = serializeJson(doc, statusBody, sizeof(statusBody));
+
+    // Versions restart at boot, so the boot ID keeps old ETags from matching
+    static const uint32_t bootId = esp_random();
+    snprintf(statusETag, sizeof(statusETag), "\"%08lx-%lu-%lu\"",
+             static_cast<unsigned long>(bootId), static_cast<unsigned long>(version),
+             static_cast<unsigned long>(catalog));
+    statusVersion = version;
+    statusCatalog = catalog;
+    statusValid = true;
+}
+
+void NetworkManager::streamState() {
+    if (stateManagerPtr == nullptr) return;
+    uint32_t version;
+    const auto state = stateManagerPtr->getSnapshot(&version);
+    if (version == lastStreamedVersion) return;
+
+    // Nobody listening: new clients get the full state when they connect
+    if (events.count() > 0) {
+        char message[224];
+        if (formatState(message, sizeof(message), state, &lastStreamed) > 0) {
+            events.send(message, "state", version);
+        }
+    }
+    lastStreamed = state;
+    lastStreamedVersion = version;
+}
+
+// Compact JSON with only the fields that differ from previous (all of them
+// when previous is null); returns 0 when nothing changed
+size_t NetworkManager::formatState(char* buffer, size_t size, const StateSnapshot& state,
+                                   const StateSnapshot* previous) {
+    size_t length = 0;
+    auto append = [&](const char* key, int value) {
+        if (length >= size) return;
+        length += snprintf(buffer + length, size - length, "%s\"%s\":%d",
+                           length == 0 ? "{" : ",", key, value);
+    };
+
+    if (!previous || state.color.red != previous->color.red) append("red", state.color.red);
+    if (!previous || state.color.green != previous->color.green) append("green", state.color.green);
+    if (!previous || state.color.blue != previous->color.blue) append("blue", state.color.blue);
+    if (!previous || state.brightness != previous->brightness) append("brightness", state.brightness);
+    if (!previous || state.effectIndex != previous->effectIndex) {
+        append("effect_index", state.effectIndex);
+        if (length < size) {
+            length += snprintf(buffer + length, size - length, ",\"effect\":\"%s\"",
+                               catalogPtr->getEffectName(state.effectIndex));
+        }
+    }
+    if (!previous || state.colorMode != previous->colorMode) {
+        if (length < size) {
+            length += snprintf(buffer + length, size - length, "%s\"mode\":\"%s\"",
+                               length == 0 ? "{" : ",", ColorModel::modeName(state.colorMode));
+        }
+    }
+    if (!previous || memcmp(state.knobs, previous->knobs, sizeof(state.knobs)) != 0) {
+        if (length < size) {
+            length += snprintf(buffer + length, size - length, "%s\"knobs\":[%d,%d,%d]",
+                               length == 0 ? "{" : ",", state.knobs[0], state.knobs[1], state.knobs[2]);
+        }
+    }
+    if (length == 0) return 0;
+    if (length < size) length += snprintf(buffer + length, size - length, "}");
+    return length < size ? length : 0;  // Truncated messages are not sent
 }
\ No newline at end of file
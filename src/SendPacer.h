@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+
+// Paces requests to WLED from the measured round-trip time instead of a
+// fixed interval: a fast node is updated more often, a slow or failing one
+// is given more room.
+class SendPacer {
+public:
+    SendPacer() :
+        averageRoundTripMs(0),
+        intervalMs(Timing::WLED_UPDATE_INTERVAL),
+        lastSendMs(0),
+        consecutiveFailures(0),
+        hasSent(false) {}
+
+    // Milliseconds to wait before the next request may start
+    unsigned long msUntilReady(unsigned long now) const {
+        if (!hasSent) return 0;
+        unsigned long elapsed = now - lastSendMs;
+        return elapsed >= intervalMs ? 0 : intervalMs - elapsed;
+    }
+
+    void recordSend(unsigned long startMs, unsigned long roundTripMs, bool success) {
+        lastSendMs = startMs;
+        hasSent = true;
+
+        if (!success) {
+            // Back off exponentially while the node is struggling or gone
+            consecutiveFailures++;
+            intervalMs = min(intervalMs * 2, Timing::WLED_BACKOFF_MAX);
+            return;
+        }
+        consecutiveFailures = 0;
+
+        // Exponential moving average, 1/8 weight for the newest sample
+        averageRoundTripMs = averageRoundTripMs == 0 ?
+            roundTripMs : (averageRoundTripMs * 7 + roundTripMs) / 8;
+        intervalMs = constrain(averageRoundTripMs * Timing::WLED_PACE_FACTOR,
+                               Timing::WLED_MIN_SEND_INTERVAL, Timing::WLED_MAX_SEND_INTERVAL);
+    }
+
+    // The path to the node was down, not the node: retry at the normal pace
+    void clearBackoff() {
+        if (consecutiveFailures == 0) return;
+        consecutiveFailures = 0;
+        intervalMs = averageRoundTripMs == 0 ? Timing::WLED_UPDATE_INTERVAL :
+            constrain(averageRoundTripMs * Timing::WLED_PACE_FACTOR,
+                      Timing::WLED_MIN_SEND_INTERVAL, Timing::WLED_MAX_SEND_INTERVAL);
+    }
+
+    unsigned long getIntervalMs() const { return intervalMs; }
+    unsigned long getAverageRoundTripMs() const { return averageRoundTripMs; }
+    uint32_t getConsecutiveFailures() const { return consecutiveFailures; }
+
+private:
+    unsigned long averageRoundTripMs;
+    unsigned long intervalMs;
+    unsigned long lastSendMs;
+    uint32_t consecutiveFailures;
+    bool hasSent;
+};
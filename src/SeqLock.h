@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <freertos/FreeRTOS.h>
+
+// Single-writer sequence lock. Readers on any task copy the value without
+// taking a lock and retry if a write overlapped; the sequence number doubles
+// as a version that changes on every write.
+//
+// The write itself runs inside a very short critical section: on a single
+// core a higher-priority reader could otherwise preempt a half-finished
+// write and spin on the odd sequence forever.
+template <typename T>
+class SeqLock {
+public:
+    explicit SeqLock(const T& initial) : value(initial) {}
+
+    void write(const T& newValue) {
+        portENTER_CRITICAL(&writeLock);
+        const uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);  // Odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        value = newValue;
+        sequence.store(seq + 2, std::memory_order_release);
+        portEXIT_CRITICAL(&writeLock);
+    }
+
+    T read(uint32_t* version = nullptr) const {
+        T copy;
+        uint32_t before;
+        uint32_t after;
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            copy = value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+
+        if (version) *version = before >> 1;
+        return copy;
+    }
+
+    uint32_t version() const { return sequence.load(std::memory_order_acquire) >> 1; }
+
+private:
+    T value;
+    std::atomic<uint32_t> sequence{0};
+    portMUX_TYPE writeLock = portMUX_INITIALIZER_UNLOCKED;
+};
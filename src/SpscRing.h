@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// Lock-free single-producer/single-consumer ring buffer. The producer is
+// typically an ISR and the consumer loop(); neither side ever blocks or
+// disables interrupts.
+//
+// head and tail run freely and are masked on access, so all Capacity slots
+// are usable and the fill level is simply head - tail.
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscRing capacity must be a power of two");
+
+public:
+    // Producer side. Returns false (and counts an overflow) when full.
+    bool push(const T& item) {
+        const uint32_t currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead - tail.load(std::memory_order_acquire) >= Capacity) {
+            overflows.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        items[currentHead & MASK] = item;
+        head.store(currentHead + 1, std::memory_order_release);  // Publish the slot
+        return true;
+    }
+
+    // Consumer side. Returns false when empty.
+    bool pop(T& item) {
+        const uint32_t currentTail = tail.load(std::memory_order_relaxed);
+        if (currentTail == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[currentTail & MASK];
+        tail.store(currentTail + 1, std::memory_order_release);  // Hand the slot back
+        return true;
+    }
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+    uint32_t getOverflows() const { return overflows.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t MASK = Capacity - 1;
+
+    T items[Capacity];
+    std::atomic<uint32_t> head{0};  // Written only by the producer
+    std::atomic<uint32_t> tail{0};  // Written only by the consumer
+    std::atomic<uint32_t> overflows{0};
+};
@@ -1,7 +1,11 @@
 #pragma once
 
 #include <Arduino.h>
-#include "config.h"  // For Effects::COUNT
+#include "config.h"
+#include "EffectCatalog.h"
+#include "ColorModel.h"
+#include "SeqLock.h"
+#include "BinaryLog.h"
 
 // Structure to hold RGB color values
 struct ColorState {
@@ -10,75 +14,151 @@ struct ColorState {
     int blue;
 };
 
+// Consistent copy of everything other tasks may want to show or send
+struct StateSnapshot {
+    ColorState color;           // As sent to WLED
+    int effectIndex;
+    int brightness;
+    ColorMode colorMode;
+    ColorModel::Knobs knobs;    // Color knob positions in that mode
+};
+
 class StateManager {
 public:
-    StateManager() : 
+    // The effect knob steps through the catalog's effects
+    explicit StateManager(const EffectCatalog& catalog) :
+        catalog(catalog),
         colorState{0, 0, 0},
+        colorMode(ColorConfig::DEFAULT_MODE),
+        knobs{0, 0, 0},
         effectIndex(0),
+        brightness(255),
         colorChangedFromButton(false),
-        effectChanged(false) {}
+        effectChanged(false),
+        brightnessChanged(false),
+        inputTimestampUs(0),
+        snapshot(StateSnapshot{{0, 0, 0}, 0, 255, ColorConfig::DEFAULT_MODE, {0, 0, 0}}) {}
 
-    // Color methods
-    void setColor(int red, int green, int blue) {
-        colorState.red = constrain(red, 0, 255);
-        colorState.green = constrain(green, 0, 255);
-        colorState.blue = constrain(blue, 0, 255);
-    }
+    // Color methods: the three color knobs move positions in the current
+    // mode, and the color sent to WLED follows from them
+    void adjustColor(int firstDelta, int secondDelta, int thirdDelta) {
+        const int deltas[ColorModel::KNOBS] = {firstDelta, secondDelta, thirdDelta};
+        bool moved[ColorModel::KNOBS] = {false, false, false};
+        bool anyMoved = false;
+        for (size_t i = 0; i < ColorModel::KNOBS; i++) {
+            // A knob the mode does not use stays put instead of drifting unseen
+            if (!ColorModel::usesKnob(colorMode, i)) continue;
+            const int position = constrain(knobs[i] + deltas[i], 0, 255);
+            if (position == knobs[i]) continue;
+            knobs[i] = position;
+            moved[i] = anyMoved = true;
+        }
+        if (!anyMoved) return;
 
-    void adjustColor(int redDelta, int greenDelta, int blueDelta) {
-        int newRed = constrain(colorState.red + redDelta, 0, 255);
-        int newGreen = constrain(colorState.green + greenDelta, 0, 255);
-        int newBlue = constrain(colorState.blue + blueDelta, 0, 255);
-        
-        // Only set changed flag if values actually changed
-        if (newRed != colorState.red || newGreen != colorState.green || newBlue != colorState.blue) {
-            DEBUG_PRINTF("Color changing from R:%d G:%d B:%d to R:%d G:%d B:%d\n",
-                colorState.red, colorState.green, colorState.blue,
-                newRed, newGreen, newBlue);
-            colorState.red = newRed;
-            colorState.green = newGreen;
-            colorState.blue = newBlue;
-            colorChangedFromButton = true;  // Set flag for any color change
+        const Rgb8 converted = ColorModel::toRgb(colorMode, knobs);
+        ColorState color{converted.red, converted.green, converted.blue};
+        // In RGB mode each knob is its own channel; one that did not move
+        // keeps its level exactly, even one from WLED the gamma table skips
+        if (colorMode == ColorMode::RGB) {
+            if (!moved[0]) color.red = colorState.red;
+            if (!moved[1]) color.green = colorState.green;
+            if (!moved[2]) color.blue = colorState.blue;
+        }
+        applyColor(color);
     }
-}
 
-    // Preset color methods
-    void setRedPreset() {
-        setColor(Buttons::PRESET_VALUE, 0, 0);
-        colorChangedFromButton = true;
-    }
+    // Preset color methods; what each preset is depends on the mode
+    void setRedPreset() { applyPreset(0); }
+    void setGreenPreset() { applyPreset(1); }
+    void setBluePreset() { applyPreset(2); }
 
-    void setGreenPreset() {
-        setColor(0, Buttons::PRESET_VALUE, 0);
-        colorChangedFromButton = true;
-    }
-
-    void setBluePreset() {
-        setColor(0, 0, Buttons::PRESET_VALUE);
-        colorChangedFromButton = true;
+    // Steps to the next color mode. The color stays as it is; the knobs
+    // take the positions that describe it in the new mode.
+    ColorMode cycleColorMode() {
+        colorMode = ColorModel::next(colorMode);
+        ColorModel::fromRgb(colorMode, toRgb8(colorState), knobs);
+        publish();
+        return colorMode;
     }
 
     // Effect methods
     void setEffect(int newIndex) {
-        effectIndex = constrain(newIndex, 0, Effects::COUNT - 1);
+        effectIndex = constrain(newIndex, 0, catalog.getEffectCount() - 1);
         effectChanged = true;
+        publish();
     }
 
     void adjustEffect(int delta) {
-        effectIndex = (effectIndex + delta + Effects::COUNT) % Effects::COUNT;
+        effectIndex = catalog.stepEffect(effectIndex, delta);
         effectChanged = true;
+        publish();
     }
 
     void resetEffect() {
         effectIndex = 0;
         effectChanged = true;
+        publish();
+    }
+
+    // State loaded from flash at boot; everything is flagged so the first
+    // loop() pushes it to WLED
+    void restoreState(const StateSnapshot& state) {
+        colorState.red = constrain(state.color.red, 0, 255);
+        colorState.green = constrain(state.color.green, 0, 255);
+        colorState.blue = constrain(state.color.blue, 0, 255);
+        colorMode = state.colorMode < ColorMode::COUNT ? state.colorMode : ColorConfig::DEFAULT_MODE;
+        memcpy(knobs, state.knobs, sizeof(knobs));
+        effectIndex = constrain(state.effectIndex, 0, catalog.getEffectCount() - 1);
+        brightness = constrain(state.brightness, 0, 255);
+        colorChangedFromButton = true;
+        effectChanged = true;
+        brightnessChanged = true;
+        publish();
+    }
+
+    // State reported by WLED itself: shown and published like any change,
+    // but the changed flags stay clear so nothing is sent back. Each returns
+    // true if the value differed.
+    bool syncColor(int red, int green, int blue) {
+        red = constrain(red, 0, 255);
+        green = constrain(green, 0, 255);
+        blue = constrain(blue, 0, 255);
+        if (red == colorState.red && green == colorState.green && blue == colorState.blue) return false;
+        colorState = ColorState{red, green, blue};
+        ColorModel::fromRgb(colorMode, toRgb8(colorState), knobs);
+        publish();
+        return true;
     }
 
-    // Getters
+    bool syncEffect(int newIndex) {
+        // Effects the catalog does not list cannot be shown; keep ours
+        if (newIndex < 0 || newIndex >= catalog.getEffectCount() || newIndex == effectIndex) return false;
+        effectIndex = newIndex;
+        publish();
+        return true;
+    }
+
+    bool syncBrightness(int newBrightness) {
+        newBrightness = constrain(newBrightness, 0, 255);
+        if (newBrightness == brightness) return false;
+        brightness = newBrightness;
+        publish();
+        return true;
+    }
+
+    // Lock-free, tear-free read for any task; version changes with every update
+    StateSnapshot getSnapshot(uint32_t* version = nullptr) const { return snapshot.read(version); }
+    uint32_t getVersion() const { return snapshot.version(); }
+
+    // Getters (loop() only)
     const ColorState& getColorState() const { return colorState; }
+    ColorMode getColorMode() const { return colorMode; }
+    const ColorModel::Knobs& getKnobs() const { return knobs; }
     int getEffectIndex() const { return effectIndex; }
     bool hasColorChanged() const { return colorChangedFromButton; }
     bool hasEffectChanged() const { return effectChanged; }
+    int getBrightness() const { return brightness; }
+    bool hasBrightnessChanged() const { return brightnessChanged; }
     
     // Individual color getters
     int getRed() const { return colorState.red; }
@@ -88,10 +168,61 @@ public:
     // Flag management
     void clearColorChanged() { colorChangedFromButton = false; }
     void clearEffectChanged() { effectChanged = false; }
+    void clearBrightnessChanged() { brightnessChanged = false; }
+
+    // ISR timestamp (micros) of the oldest input not yet handed to WLED,
+    // for latency measurement; 0 when there is none (loop() only)
+    void noteInput(uint32_t timestampUs) {
+        if (inputTimestampUs == 0) inputTimestampUs = timestampUs;
+    }
+    uint32_t takeInputTimestamp() {
+        uint32_t timestampUs = inputTimestampUs;
+        inputTimestampUs = 0;
+        return timestampUs;
+    }
 
 private:
+    const EffectCatalog& catalog;
     ColorState colorState;
+    ColorMode colorMode;
+    ColorModel::Knobs knobs;
     int effectIndex;
+    int brightness;
     volatile bool colorChangedFromButton;
     volatile bool effectChanged;
+    volatile bool brightnessChanged;
+    uint32_t inputTimestampUs;
+    SeqLock<StateSnapshot> snapshot;
+
+    void applyColor(const ColorState& color) {
+        if (color.red == colorState.red && color.green == colorState.green && color.blue == colorState.blue) {
+            publish();  // Knobs moved within one output step; show them anyway
+            return;
+        }
+        LOG(COLOR_CHANGE,
+            colorState.red, colorState.green, colorState.blue,
+            color.red, color.green, color.blue);
+        colorState = color;
+        colorChangedFromButton = true;  // Set flag for any color change
+        publish();
+    }
+
+    void applyPreset(size_t button) {
+        ColorModel::preset(colorMode, button, knobs);
+        const Rgb8 converted = ColorModel::toRgb(colorMode, knobs);
+        colorState = ColorState{converted.red, converted.green, converted.blue};
+        colorChangedFromButton = true;
+        publish();
+    }
+
+    static Rgb8 toRgb8(const ColorState& color) {
+        return Rgb8{static_cast<uint8_t>(color.red), static_cast<uint8_t>(color.green),
+                    static_cast<uint8_t>(color.blue)};
+    }
+
+    void publish() {
+        StateSnapshot state{colorState, effectIndex, brightness, colorMode, {}};
+        memcpy(state.knobs, knobs, sizeof(knobs));
+        snapshot.write(state);
+    }
 };
\ No newline at end of file
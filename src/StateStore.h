@@ -0,0 +1,247 @@
+#pragma once
+
+#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "config.h"
+#include "StateManager.h"
+#include "BinaryLog.h"
+
+// Keeps the knob state in NVS across reboots. A commit happens only once
+// the knobs have been idle for a while, and successive commits rotate
+// through several record keys so the same flash entry is not rewritten
+// every time.
+class StateStore {
+public:
+    StateStore();
+
+    // Opens the NVS namespace and loads the newest valid record (setup())
+    bool restore(StateSnapshot& state);
+    // Starts the commit task, which watches the published snapshot
+    bool begin(StateManager& stateManager);
+
+    uint32_t getWrites() const { return writes; }
+    uint32_t getFailedWrites() const { return failedWrites; }
+    uint32_t getWritesLastHour();
+    uint32_t getSequence() const { return sequence; }
+    bool wasRestored() const { return restored; }
+
+private:
+    // One saved state; the checksum also rejects records from older layouts
+    struct Record {
+        uint8_t format;
+        uint8_t red;
+        uint8_t green;
+        uint8_t blue;
+        uint8_t effectIndex;
+        uint8_t brightness;
+        uint8_t colorMode;
+        uint8_t knobs[ColorModel::KNOBS];
+        uint16_t checksum;
+        uint32_t sequence;      // Newest record wins; also picks the next slot
+    };
+
+    static constexpr uint8_t RECORD_FORMAT = 2;   // 2: color mode and knob positions
+    static constexpr size_t HOUR_BUCKETS = 60;    // One per minute
+
+    Preferences preferences;
+    StateManager* stateManagerPtr;
+    TaskHandle_t taskHandle;
+    bool opened;
+    bool restored;
+    uint32_t sequence;          // Of the newest record in flash
+    StateSnapshot saved;        // What that record holds
+    volatile uint32_t writes;
+    volatile uint32_t failedWrites;
+
+    // Commits per minute over the last hour; minuteStamps tells stale buckets apart
+    portMUX_TYPE statsLock;
+    uint16_t minuteWrites[HOUR_BUCKETS];
+    uint32_t minuteStamps[HOUR_BUCKETS];
+
+    static void taskEntry(void* param);
+    void runTask();
+    bool commit(const StateSnapshot& state);
+    void countWrite();
+    static void slotKey(char* key, size_t size, uint32_t slot);
+    static uint16_t checksum(const Record& record);
+    static bool sameState(const StateSnapshot& a, const StateSnapshot& b);
+};
+
+StateStore::StateStore() :
+    stateManagerPtr(nullptr),
+    taskHandle(nullptr),
+    opened(false),
+    restored(false),
+    sequence(0),
+    saved{},
+    writes(0),
+    failedWrites(0),
+    statsLock(portMUX_INITIALIZER_UNLOCKED),
+    minuteWrites{},
+    minuteStamps{} {}
+
+bool StateStore::restore(StateSnapshot& state) {
+    opened = preferences.begin(Storage::NAMESPACE, false);
+    if (!opened) {
+        DEBUG_PRINTLN("NVS namespace could not be opened; state will not persist");
+        return false;
+    }
+
+    Record newest{};
+    bool found = false;
+    for (uint32_t slot = 0; slot < Storage::RECORD_SLOTS; slot++) {
+        char key[8];
+        slotKey(key, sizeof(key), slot);
+        Record record;
+        if (preferences.getBytes(key, &record, sizeof(record)) != sizeof(record)) continue;
+        if (record.format != RECORD_FORMAT || record.checksum != checksum(record)) continue;
+        // Wrap-safe: a later sequence is "ahead" of the current newest
+        if (!found || static_cast<int32_t>(record.sequence - newest.sequence) > 0) {
+            newest = record;
+            found = true;
+        }
+    }
+    if (!found) return false;
+
+    sequence = newest.sequence;
+    saved = StateSnapshot{{newest.red, newest.green, newest.blue}, newest.effectIndex, newest.brightness,
+                          static_cast<ColorMode>(newest.colorMode), {}};
+    memcpy(saved.knobs, newest.knobs, sizeof(saved.knobs));
+    state = saved;
+    restored = true;
+    DEBUG_PRINTF("Restored state #%lu - R:%d G:%d B:%d Effect:%d Brightness:%d Mode:%s\n",
+                 static_cast<unsigned long>(sequence), state.color.red, state.color.green,
+                 state.color.blue, state.effectIndex, state.brightness, ColorModel::modeName(state.colorMode));
+    return true;
+}
+
+bool StateStore::begin(StateManager& stateManager) {
+    if (!opened) return false;
+    stateManagerPtr = &stateManager;
+    if (!restored) saved = stateManager.getSnapshot();  // Defaults need no record
+
+    if (xTaskCreate(taskEntry, "store", Tasks::STORE_STACK_SIZE, this,
+                    Tasks::STORE_PRIORITY, &taskHandle) != pdPASS) {
+        DEBUG_PRINTLN("State store task creation failed");
+        taskHandle = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void StateStore::taskEntry(void* param) {
+    static_cast<StateStore*>(param)->runTask();
+}
+
+// Flash writes stall the CPU for milliseconds, so they happen here rather
+// than in loop(); the snapshot is lock-free to read from any task
+void StateStore::runTask() {
+    uint32_t seenVersion = stateManagerPtr->getVersion();
+    unsigned long changedMs = millis();
+    unsigned long lastCommitMs = 0;
+    bool committed = false;
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(Storage::CHECK_INTERVAL));
+        uint32_t version;
+        const StateSnapshot state = stateManagerPtr->getSnapshot(&version);
+        const unsigned long now = millis();
+        if (version != seenVersion) {
+            seenVersion = version;
+            changedMs = now;    // Still turning; start the idle wait over
+            continue;
+        }
+        if (sameState(state, saved)) continue;
+        if (now - changedMs < Storage::SAVE_IDLE) continue;
+        if (committed && now - lastCommitMs < Storage::MIN_SAVE_INTERVAL) continue;
+
+        if (commit(state)) {
+            lastCommitMs = now;
+            committed = true;
+        }
+    }
+}
+
+bool StateStore::commit(const StateSnapshot& state) {
+    Record record{};
+    record.format = RECORD_FORMAT;
+    record.red = state.color.red;
+    record.green = state.color.green;
+    record.blue = state.color.blue;
+    record.effectIndex = state.effectIndex;
+    record.brightness = state.brightness;
+    record.colorMode = static_cast<uint8_t>(state.colorMode);
+    memcpy(record.knobs, state.knobs, sizeof(record.knobs));
+    record.sequence = sequence + 1;
+    record.checksum = checksum(record);
+
+    // The newest record is never overwritten, so a failed write leaves it intact
+    const uint32_t slot = record.sequence % Storage::RECORD_SLOTS;
+    char key[8];
+    slotKey(key, sizeof(key), slot);
+    if (preferences.putBytes(key, &record, sizeof(record)) != sizeof(record)) {
+        failedWrites++;
+        LOG(STORE_FAILED, slot);
+        return false;
+    }
+
+    sequence = record.sequence;
+    saved = state;
+    countWrite();
+    LOG(STORE_COMMIT,
+        sequence, slot, state.color.red, state.color.green, state.color.blue,
+        state.effectIndex, state.brightness);
+    return true;
+}
+
+void StateStore::countWrite() {
+    const uint32_t minute = millis() / 60000;
+    const size_t bucket = minute % HOUR_BUCKETS;
+    portENTER_CRITICAL(&statsLock);
+    if (minuteStamps[bucket] != minute) {
+        minuteStamps[bucket] = minute;
+        minuteWrites[bucket] = 0;
+    }
+    minuteWrites[bucket]++;
+    writes++;
+    portEXIT_CRITICAL(&statsLock);
+}
+
+uint32_t StateStore::getWritesLastHour() {
+    const uint32_t minute = millis() / 60000;
+    uint32_t total = 0;
+    portENTER_CRITICAL(&statsLock);
+    for (size_t i = 0; i < HOUR_BUCKETS; i++) {
+        if (minute - minuteStamps[i] < HOUR_BUCKETS) total += minuteWrites[i];
+    }
+    portEXIT_CRITICAL(&statsLock);
+    return total;
+}
+
+void StateStore::slotKey(char* key, size_t size, uint32_t slot) {
+    snprintf(key, size, "state%lu", static_cast<unsigned long>(slot));
+}
+
+// Fletcher-16 over everything but the checksum itself
+uint16_t StateStore::checksum(const Record& record) {
+    const uint8_t bytes[] = {
+        record.format, record.red, record.green, record.blue, record.effectIndex, record.brightness,
+        record.colorMode, record.knobs[0], record.knobs[1], record.knobs[2],
+        static_cast<uint8_t>(record.sequence), static_cast<uint8_t>(record.sequence >> 8),
+        static_cast<uint8_t>(record.sequence >> 16), static_cast<uint8_t>(record.sequence >> 24)
+    };
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+    for (uint8_t byte : bytes) {
+        sum1 = (sum1 + byte) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    return (sum2 << 8) | sum1;
+}
+
+bool StateStore::sameState(const StateSnapshot& a, const StateSnapshot& b) {
+    return a.color.red == b.color.red && a.color.green == b.color.green &&
+           a.color.blue == b.color.blue && a.effectIndex == b.effectIndex &&
+           a.brightness == b.brightness && a.colorMode == b.colorMode &&
+           memcmp(a.knobs, b.knobs, sizeof(a.knobs)) == 0;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+
+// Spots knob sweeps in the colors a target sends and extrapolates them.
+// Once a sweep is established, each request can carry where the knob will
+// be at the next send, and WLED fades there, instead of the light jumping
+// from one exact color to the next at every send.
+class SweepPredictor {
+public:
+    SweepPredictor() :
+        lastMs(0),
+        startMs(0),
+        last{},
+        velocity{},
+        samples(0),
+        hasLast(false) {}
+
+    // Records a color about to be sent at the pace intervalMs. A color
+    // sent within two intervals of the previous one gives a rate sample;
+    // Timing::WLED_SWEEP_SAMPLES consistent samples in a row make a sweep.
+    // Returns true while sweeping.
+    bool observe(unsigned long nowMs, int red, int green, int blue, unsigned long intervalMs) {
+        const int color[CHANNELS] = {red, green, blue};
+        const unsigned long elapsedMs = nowMs - lastMs;
+
+        if (!hasLast || elapsedMs == 0 || elapsedMs > 2 * intervalMs) {
+            samples = 0;
+            startMs = nowMs;
+        } else {
+            float rate[CHANNELS];
+            for (size_t i = 0; i < CHANNELS; i++) {
+                rate[i] = static_cast<float>(color[i] - last[i]) / elapsedMs;
+            }
+            if (samples > 0 && consistent(rate)) {
+                // Averaged with the earlier samples, so one uneven detent does not swing the target
+                for (size_t i = 0; i < CHANNELS; i++) velocity[i] = (velocity[i] + rate[i]) / 2;
+                if (samples < Timing::WLED_SWEEP_SAMPLES) samples++;
+            } else {
+                for (size_t i = 0; i < CHANNELS; i++) velocity[i] = rate[i];
+                samples = 1;
+                startMs = lastMs;
+            }
+        }
+        for (size_t i = 0; i < CHANNELS; i++) last[i] = color[i];
+        lastMs = nowMs;
+        hasLast = true;
+        return isActive();
+    }
+
+    // Where the last observed color is heading after horizonMs at the current rate
+    void predict(unsigned long horizonMs, int& red, int& green, int& blue) const {
+        int* const color[CHANNELS] = {&red, &green, &blue};
+        for (size_t i = 0; i < CHANNELS; i++) {
+            *color[i] = constrain(static_cast<int>(last[i] + velocity[i] * horizonMs + 0.5f), 0, 255);
+        }
+    }
+
+    // The knob has stopped, or the pace no longer allows a fade
+    void end() {
+        samples = 0;
+        for (float& rate : velocity) rate = 0;
+    }
+
+    bool isActive() const { return samples >= Timing::WLED_SWEEP_SAMPLES; }
+    unsigned long getLastMs() const { return lastMs; }
+    unsigned long getStartMs() const { return startMs; }   // First send of the current run
+
+private:
+    static constexpr size_t CHANNELS = 3;
+
+    unsigned long lastMs;
+    unsigned long startMs;
+    int last[CHANNELS];
+    float velocity[CHANNELS];   // Color units per ms
+    uint8_t samples;            // Consistent rate samples in a row
+    bool hasLast;
+
+    // Same direction on every channel, and a speed within
+    // Timing::WLED_SWEEP_RATE_SPREAD of the average so far
+    bool consistent(const float (&rate)[CHANNELS]) const {
+        float speed = 0;
+        float average = 0;
+        for (size_t i = 0; i < CHANNELS; i++) {
+            if (rate[i] * velocity[i] < 0) return false;
+            speed += fabsf(rate[i]);
+            average += fabsf(velocity[i]);
+        }
+        return speed > 0 && speed * Timing::WLED_SWEEP_RATE_SPREAD >= average &&
+               speed <= average * Timing::WLED_SWEEP_RATE_SPREAD;
+    }
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "config.h"
+#include "WLEDTarget.h"
+#include "WLEDSync.h"
+#include "EffectCatalog.h"
+
+// Fans every update out to all configured WLED targets. Each target sends
+// from its own task, so updates reach the devices in parallel.
+class WLEDController {
+public:
+    WLEDController();
+    bool begin();
+
+    // Non-blocking: record the desired state for every target. inputUs is
+    // the micros() timestamp of the input behind the change, 0 if untimed.
+    void updateColor(int red, int green, int blue, uint32_t inputUs = 0);
+    void updateEffect(int effectIndex, uint32_t inputUs = 0);
+    void updateBrightness(int brightness, uint32_t inputUs = 0);
+    void setTransport(WLEDTransport transport);
+    // Re-send the latest state to every target, e.g. after Wi-Fi came back
+    void resendState();
+
+    // Fetch the next completed request from any target (called from loop())
+    bool pollResult(WLEDResult& result);
+
+    // State the followed node reported over its WebSocket (loop()). Pushes
+    // are held while our own requests to that node may still echo back, so
+    // a stale echo never rewinds the knobs.
+    bool pollRemoteState(WLEDRemoteState& state);
+    // Bring the other targets in line with a remote change; the node that
+    // reported it only takes note, so nothing is echoed back to it
+    void forwardRemoteState(const WLEDRemoteState& state, uint8_t fields);
+
+    size_t getTargetCount() const { return NetworkConfig::WLED_TARGET_COUNT; }
+    const char* getTargetAddress(size_t index) const { return targets[index].getAddress(); }
+    WLEDConnectionStats getConnectionStats(size_t index) { return targets[index].getConnectionStats(); }
+    LatencyMetrics& getLatencyMetrics() { return latency; }
+    bool isSyncConnected() const { return sync.isConnected(); }
+    uint32_t getSyncPushCount() const { return sync.getPushCount(); }
+    // Effect names of NetworkConfig::WLED_CATALOG_TARGET; restore() it from
+    // flash in setup(), begin() fetches it once the link is up
+    EffectCatalog& getCatalog() { return catalog; }
+
+private:
+    WLEDTarget targets[NetworkConfig::WLED_TARGET_COUNT];
+    QueueHandle_t resultQueue;
+    LatencyMetrics latency;     // Shared by all targets
+    uint32_t lastHandoffUs;
+    WLEDSync sync;
+    EffectCatalog catalog;
+    WLEDRemoteState heldRemote;
+    bool remoteHeld;
+
+    void recordHandoff(uint32_t inputUs);
+};
+
+WLEDController::WLEDController() :
+    resultQueue(nullptr),
+    lastHandoffUs(0),
+    heldRemote{},
+    remoteHeld(false) {}
+
+bool WLEDController::begin() {
+    resultQueue = xQueueCreate(Tasks::WLED_RESULT_QUEUE_LENGTH * NetworkConfig::WLED_TARGET_COUNT,
+                               sizeof(WLEDResult));
+    if (resultQueue == nullptr) {
+        DEBUG_PRINTLN("WLED result queue allocation failed");
+        return false;
+    }
+
+    size_t started = 0;
+    for (size_t i = 0; i < NetworkConfig::WLED_TARGET_COUNT; i++) {
+        if (targets[i].begin(i, NetworkConfig::WLED_IPS[i], resultQueue, &latency)) {
+            started++;
+        }
+    }
+    if (NetworkConfig::WLED_SYNC_TARGET >= 0) {
+        sync.begin(NetworkConfig::WLED_IPS[NetworkConfig::WLED_SYNC_TARGET]);
+    }
+    catalog.begin(NetworkConfig::WLED_IPS[NetworkConfig::WLED_CATALOG_TARGET]);
+    return started > 0;
+}
+
+void WLEDController::updateColor(int red, int green, int blue, uint32_t inputUs) {
+    recordHandoff(inputUs);
+    for (auto& target : targets) target.updateColor(red, green, blue, inputUs);
+}
+
+void WLEDController::updateEffect(int effectIndex, uint32_t inputUs) {
+    recordHandoff(inputUs);
+    for (auto& target : targets) target.updateEffect(effectIndex, inputUs);
+}
+
+void WLEDController::updateBrightness(int brightness, uint32_t inputUs) {
+    recordHandoff(inputUs);
+    for (auto& target : targets) target.updateBrightness(brightness, inputUs);
+}
+
+// Input-to-queue time is the same for every target and every field the
+// input changed, so it is counted once here
+void WLEDController::recordHandoff(uint32_t inputUs) {
+    if (inputUs == 0 || inputUs == lastHandoffUs) return;
+    latency.inputToQueue.record(micros() - inputUs);
+    lastHandoffUs = inputUs;
+}
+
+void WLEDController::resendState() {
+    for (auto& target : targets) target.resendState();
+}
+
+void WLEDController::setTransport(WLEDTransport transport) {
+    for (auto& target : targets) target.setTransport(transport);
+}
+
+bool WLEDController::pollResult(WLEDResult& result) {
+    if (resultQueue == nullptr) return false;
+    return xQueueReceive(resultQueue, &result, 0) == pdTRUE;
+}
+
+bool WLEDController::pollRemoteState(WLEDRemoteState& state) {
+    if (NetworkConfig::WLED_SYNC_TARGET < 0) return false;
+    WLEDRemoteState incoming;
+    if (sync.poll(incoming)) {
+        heldRemote = incoming;  // WLED pushes its whole state; the newest wins
+        remoteHeld = true;
+    }
+    if (!remoteHeld) return false;
+    if (!targets[NetworkConfig::WLED_SYNC_TARGET].isIdleFor(Timing::WLED_SYNC_HOLDOFF)) return false;
+
+    state = heldRemote;
+    remoteHeld = false;
+    return true;
+}
+
+void WLEDController::forwardRemoteState(const WLEDRemoteState& state, uint8_t fields) {
+    for (size_t i = 0; i < NetworkConfig::WLED_TARGET_COUNT; i++) {
+        if (static_cast<int>(i) == NetworkConfig::WLED_SYNC_TARGET) {
+            targets[i].adoptState(fields, state.red, state.green, state.blue,
+                                  state.effectIndex, state.brightness);
+            continue;
+        }
+        if (fields & WLEDField::COLOR) targets[i].updateColor(state.red, state.green, state.blue);
+        if (fields & WLEDField::EFFECT) targets[i].updateEffect(state.effectIndex);
+        if (fields & WLEDField::BRIGHTNESS) targets[i].updateBrightness(state.brightness);
+    }
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+
+// Builds WLED /json/state bodies in a fixed buffer without heap allocation.
+// The constant parts of each message are pre-written templates; only the
+// numeric fields are formatted at send time.
+class WLEDPayload {
+public:
+    static constexpr size_t CAPACITY = 128;
+
+    // {"on":true,"v":false  -- "v":false keeps WLED's reply to {"success":true}
+    void beginState();
+    void addBrightness(int brightness);
+    void addLiveOff();
+    // "tt": a transition for this request only, leaving WLED's default alone
+    void addTransition(unsigned long durationMs);
+
+    // Segment 0 fields; the first call opens ,"seg":[{
+    void addColor(int red, int green, int blue);
+    void addEffect(int effectIndex);
+
+    // Closes the segment (if any) and the state object
+    void end();
+
+    uint8_t* data() { return reinterpret_cast<uint8_t*>(buffer); }
+    size_t length() const { return size; }
+    const char* c_str() const { return buffer; }
+    bool overflowed() const { return truncated; }
+
+private:
+    char buffer[CAPACITY];
+    size_t size = 0;
+    bool segmentOpen = false;
+    bool truncated = false;
+
+    template <size_t N>
+    void appendLiteral(const char (&text)[N]);
+    void appendUint(unsigned int value);
+    void openSegmentField();
+};
+
+template <size_t N>
+void WLEDPayload::appendLiteral(const char (&text)[N]) {
+    constexpr size_t len = N - 1;  // Drop the terminator
+    if (size + len >= CAPACITY) {
+        truncated = true;
+        return;
+    }
+    memcpy(buffer + size, text, len);
+    size += len;
+    buffer[size] = '\0';
+}
+
+void WLEDPayload::appendUint(unsigned int value) {
+    char digits[10];
+    size_t count = 0;
+    do {
+        digits[count++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    if (size + count >= CAPACITY) {
+        truncated = true;
+        return;
+    }
+    while (count > 0) {
+        buffer[size++] = digits[--count];
+    }
+    buffer[size] = '\0';
+}
+
+void WLEDPayload::openSegmentField() {
+    if (segmentOpen) {
+        appendLiteral(",");
+    } else {
+        appendLiteral(",\"seg\":[{");
+        segmentOpen = true;
+    }
+}
+
+void WLEDPayload::beginState() {
+    size = 0;
+    segmentOpen = false;
+    truncated = false;
+    appendLiteral("{\"on\":true,\"v\":false");
+}
+
+void WLEDPayload::addBrightness(int brightness) {
+    appendLiteral(",\"bri\":");
+    appendUint(constrain(brightness, 0, 255));
+}
+
+void WLEDPayload::addLiveOff() {
+    appendLiteral(",\"live\":false");
+}
+
+void WLEDPayload::addTransition(unsigned long durationMs) {
+    appendLiteral(",\"tt\":");
+    appendUint((durationMs + Timing::WLED_TRANSITION_UNIT / 2) / Timing::WLED_TRANSITION_UNIT);
+}
+
+void WLEDPayload::addColor(int red, int green, int blue) {
+    openSegmentField();
+    appendLiteral("\"col\":[[");
+    appendUint(constrain(red, 0, 255));
+    appendLiteral(",");
+    appendUint(constrain(green, 0, 255));
+    appendLiteral(",");
+    appendUint(constrain(blue, 0, 255));
+    appendLiteral("]]");
+}
+
+void WLEDPayload::addEffect(int effectIndex) {
+    openSegmentField();
+    appendLiteral("\"fx\":");
+    appendUint(max(effectIndex, 0));
+}
+
+void WLEDPayload::end() {
+    if (segmentOpen) {
+        appendLiteral("}]}");
+        segmentOpen = false;
+    } else {
+        appendLiteral("}");
+    }
+}
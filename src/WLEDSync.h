@@ -0,0 +1,157 @@
+#pragma once
+
+#include <WebSocketsClient.h>
+#include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include "config.h"
+#include "WLEDTarget.h"  // For WLEDField
+#include "BinaryLog.h"
+
+// State WLED pushed over its WebSocket; only the fields it carried are valid
+struct WLEDRemoteState {
+    uint8_t fields;             // WLEDField bits present in the push
+    int red;
+    int green;
+    int blue;
+    int effectIndex;
+    int brightness;
+};
+
+// One persistent subscription to a WLED node's /ws. WLED pushes its full
+// state whenever it changes, whoever changed it, so the knobs can follow
+// the WLED app without polling /json/state.
+class WLEDSync {
+public:
+    WLEDSync();
+    bool begin(const char* address);
+
+    // Latest push not yet taken (loop()); older pushes are overwritten
+    bool poll(WLEDRemoteState& state);
+
+    bool isConnected() const { return connected; }
+    uint32_t getPushCount() const { return pushes; }
+
+private:
+    WebSocketsClient socket;    // Owned by the sync task
+    QueueHandle_t mailbox;      // Length one, overwritten with every push
+    TaskHandle_t taskHandle;
+    volatile bool connected;
+    volatile uint32_t pushes;
+
+    static void taskEntry(void* param);
+    void runTask();
+    void onEvent(WStype_t type, uint8_t* payload, size_t length);
+    void parseState(const uint8_t* payload, size_t length);
+};
+
+WLEDSync::WLEDSync() :
+    mailbox(nullptr),
+    taskHandle(nullptr),
+    connected(false),
+    pushes(0) {}
+
+bool WLEDSync::begin(const char* address) {
+    mailbox = xQueueCreate(1, sizeof(WLEDRemoteState));
+    if (mailbox == nullptr) {
+        DEBUG_PRINTLN("WLED sync mailbox allocation failed");
+        return false;
+    }
+
+    socket.begin(address, NetworkConfig::WLED_PORT, "/ws");
+    socket.setReconnectInterval(NetworkConfig::WLED_SYNC_RECONNECT_MS);
+    socket.onEvent([this](WStype_t type, uint8_t* payload, size_t length) {
+        onEvent(type, payload, length);
+    });
+
+    if (xTaskCreate(taskEntry, "wledsync", Tasks::WLED_SYNC_STACK_SIZE, this,
+                    Tasks::WLED_PRIORITY, &taskHandle) != pdPASS) {
+        DEBUG_PRINTLN("WLED sync task creation failed");
+        taskHandle = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool WLEDSync::poll(WLEDRemoteState& state) {
+    if (mailbox == nullptr) return false;
+    return xQueueReceive(mailbox, &state, 0) == pdTRUE;
+}
+
+void WLEDSync::taskEntry(void* param) {
+    static_cast<WLEDSync*>(param)->runTask();
+}
+
+void WLEDSync::runTask() {
+    for (;;) {
+        // Connects, reconnects and delivers pushes through onEvent(). Held
+        // back while Wi-Fi is down, so a failed attempt does not push the
+        // first real one out by a whole reconnect interval.
+        if (WiFi.status() == WL_CONNECTED || connected) socket.loop();
+        vTaskDelay(pdMS_TO_TICKS(Timing::WLED_SYNC_POLL_INTERVAL));
+    }
+}
+
+void WLEDSync::onEvent(WStype_t type, uint8_t* payload, size_t length) {
+    switch (type) {
+        case WStype_CONNECTED:
+            connected = true;
+            LOG(WLED_SYNC_UP);
+            break;
+        case WStype_DISCONNECTED:
+            if (connected) LOG(WLED_SYNC_DOWN);
+            connected = false;
+            break;
+        case WStype_TEXT:
+            parseState(payload, length);
+            break;
+        default:
+            break;
+    }
+}
+
+// WLED sends {"state":{...},"info":{...}} of a few KB; the filter keeps
+// only the fields the knobs control, so the document stays small
+void WLEDSync::parseState(const uint8_t* payload, size_t length) {
+    JsonDocument filter;
+    filter["state"]["bri"] = true;
+    filter["state"]["live"] = true;
+    filter["state"]["seg"][0]["col"] = true;
+    filter["state"]["seg"][0]["fx"] = true;
+
+    JsonDocument doc;
+    const DeserializationError error =
+        deserializeJson(doc, payload, length, DeserializationOption::Filter(filter));
+    if (error) {
+        LOG(WLED_SYNC_BAD, length);
+        return;
+    }
+
+    JsonObject state = doc["state"];
+    if (state.isNull()) return;  // Not a state push
+    // While WLED shows our realtime frames its segment color is stale
+    if (state["live"] | false) return;
+
+    WLEDRemoteState remote{};
+    if (state["bri"].is<int>()) {
+        remote.brightness = state["bri"];
+        remote.fields |= WLEDField::BRIGHTNESS;
+    }
+    JsonObject segment = state["seg"][0];
+    JsonArray color = segment["col"][0];
+    if (color.size() >= 3) {
+        remote.red = color[0];
+        remote.green = color[1];
+        remote.blue = color[2];
+        remote.fields |= WLEDField::COLOR;
+    }
+    if (segment["fx"].is<int>()) {
+        remote.effectIndex = segment["fx"];
+        remote.fields |= WLEDField::EFFECT;
+    }
+    if (remote.fields == 0) return;
+
+    pushes++;
+    xQueueOverwrite(mailbox, &remote);
+}
@@ -0,0 +1,567 @@
+#pragma once
+
+#include <HTTPClient.h>
+#include <WiFiUdp.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include "config.h"
+#include "WLEDPayload.h"
+#include "SendPacer.h"
+#include "SweepPredictor.h"
+#include "LatencyHistogram.h"
+
+// Parts of the WLED state carried by one request
+namespace WLEDField {
+    constexpr uint8_t COLOR = 1 << 0;
+    constexpr uint8_t EFFECT = 1 << 1;
+    constexpr uint8_t BRIGHTNESS = 1 << 2;
+}
+
+// Outcome of one request, reported back from a target's network task
+struct WLEDResult {
+    uint8_t target;             // Index into NetworkConfig::WLED_IPS
+    uint8_t fields;             // WLEDField bits merged into this request
+    int httpCode;               // HTTP status, or negative HTTPClient error
+    unsigned long roundTripMs;
+    uint32_t latencyUs;         // Input edge to acknowledgement, 0 if not timed
+};
+
+// Connection and health bookkeeping for one WLED target
+struct WLEDConnectionStats {
+    uint32_t requests;
+    uint32_t reused;            // Sent on an already-open connection
+    uint32_t reconnects;        // Needed a fresh TCP handshake
+    uint32_t retries;           // Connection dropped under us and the request was resent
+    unsigned long reusedTimeMs; // Summed round-trip time of reused requests
+    unsigned long freshTimeMs;  // Summed round-trip time of requests that reconnected
+    uint32_t realtimeFrames;    // DRGB frames sent over UDP
+    uint32_t coalesced;         // Updates merged into a change that was still pending
+    uint32_t sweeps;            // Knob sweeps sent as predicted colors with transitions
+    uint32_t sweepRequests;     // Requests those took, from the opening color to the settled one
+    unsigned long sweepTimeMs;  // Summed time from each sweep's first request to its last
+    unsigned long averageRoundTripMs;
+    unsigned long sendIntervalMs;   // Current adaptive pace, including failure backoff
+    uint32_t consecutiveFailures;   // 0 while the target is healthy
+};
+
+// One WLED node with its own connection, pacing and network task, so a
+// slow or dead node never holds up updates to the others
+class WLEDTarget {
+public:
+    WLEDTarget();
+    bool begin(uint8_t index, const char* address, QueueHandle_t results, LatencyMetrics* metrics);
+
+    // Non-blocking: record the desired state and wake the network task.
+    // Changes made before the next send are merged, latest value wins.
+    // inputUs is the micros() of the input behind the change (0 if none);
+    // a merged request is timed from its oldest input.
+    void updateColor(int red, int green, int blue, uint32_t inputUs = 0);
+    void updateEffect(int effectIndex, uint32_t inputUs = 0);
+    void updateBrightness(int brightness, uint32_t inputUs = 0);
+    void setTransport(WLEDTransport transport);
+
+    // Take over state the node reported itself: updates what later
+    // requests carry without sending anything back
+    void adoptState(uint8_t fields, int red, int green, int blue, int effectIndex, int brightness);
+
+    // Send every field ever requested again, without failure backoff; for
+    // when the network was down and WLED may have missed the latest state
+    void resendState();
+
+    // True once nothing has been pending, in flight or streaming for ms;
+    // until then the node's own state reports may lag behind ours
+    bool isIdleFor(unsigned long ms);
+
+    WLEDConnectionStats getConnectionStats();
+    const char* getAddress() const { return host; }
+
+private:
+    // Latest desired state, shared between loop() and the network task
+    struct PendingState {
+        int red;
+        int green;
+        int blue;
+        int effectIndex;
+        int brightness;
+        WLEDTransport transport;
+        uint8_t dirty;          // WLEDField bits changed since the last send
+        uint32_t inputUs;       // Oldest unsent input, 0 if none
+        uint32_t queuedUs;      // When that input was handed to this target
+    };
+
+    static constexpr size_t REALTIME_HEADER_SIZE = 2;
+    static constexpr size_t REALTIME_FRAME_SIZE =
+        REALTIME_HEADER_SIZE + 3 * NetworkConfig::WLED_LED_COUNT;
+    static_assert(NetworkConfig::WLED_LED_COUNT <= 490, "DRGB frames are limited to 490 LEDs");
+
+    uint8_t targetIndex;
+    const char* host;
+
+    // Owned by the network task; kept open between requests
+    HTTPClient http;
+    WiFiClient client;
+    bool connectionOpen;
+    WLEDConnectionStats stats;
+    WLEDPayload payload;
+    SendPacer pacer;
+
+    // Realtime output, also owned by the network task
+    WiFiUDP udp;
+    IPAddress wledAddress;
+    uint8_t realtimeFrame[REALTIME_FRAME_SIZE];
+    WLEDTransport activeTransport;
+    volatile bool realtimeActive;   // WLED is showing our frames; color not yet committed via JSON
+    unsigned long lastFrameMs;
+    volatile bool busy;             // Network task is working through pending changes
+    volatile unsigned long idleSinceMs;
+
+    // Sweep prediction, also owned by the network task
+    SweepPredictor predictor;
+    volatile bool sweeping;         // WLED is fading toward a predicted color
+    bool settleOwed;                // The last color sent was a prediction, not the knob's color
+    unsigned long sweepStartMs;     // First send of the current sweep
+
+    TaskHandle_t taskHandle;
+    QueueHandle_t resultQueue;
+    LatencyMetrics* latency;
+    portMUX_TYPE pendingLock;
+    PendingState pending;
+    uint8_t requestedFields;        // WLEDField bits ever marked dirty
+    volatile bool backoffReset;     // Asks the network task to drop failure backoff
+
+    static void taskEntry(void* param);
+    void runTask();
+    void markDirty(uint8_t field, uint32_t inputUs);
+    bool takePending(PendingState& state);
+    unsigned long msUntilNextSend() const;
+    void sendState(const PendingState& state, uint8_t fields, bool leaveRealtime, unsigned long transitionMs = 0);
+    void sendColorState(const PendingState& state, uint8_t fields);
+    void settleSweep(const PendingState& state);
+    void endSweep(bool landed);
+    bool sendRealtimeColor(int red, int green, int blue);
+    void openConnection();
+    void sendRequest(uint8_t fields, const PendingState& state);
+    bool drainResponse();
+    uint32_t recordLatency(const PendingState& state, uint32_t sendStartUs, bool success);
+    void reportResult(uint8_t fields, int httpCode, unsigned long roundTripMs, uint32_t latencyUs = 0);
+};
+
+WLEDTarget::WLEDTarget() :
+    targetIndex(0),
+    host(""),
+    connectionOpen(false),
+    stats{},
+    realtimeFrame{},
+    activeTransport(NetworkConfig::WLED_TRANSPORT),
+    realtimeActive(false),
+    lastFrameMs(0),
+    busy(false),
+    idleSinceMs(0),
+    sweeping(false),
+    settleOwed(false),
+    sweepStartMs(0),
+    taskHandle(nullptr),
+    resultQueue(nullptr),
+    latency(nullptr),
+    pendingLock(portMUX_INITIALIZER_UNLOCKED),
+    pending{0, 0, 0, 0, 255, NetworkConfig::WLED_TRANSPORT, 0, 0, 0},
+    requestedFields(0),
+    backoffReset(false) {}
+
+bool WLEDTarget::begin(uint8_t index, const char* address, QueueHandle_t results, LatencyMetrics* metrics) {
+    targetIndex = index;
+    host = address;
+    resultQueue = results;
+    latency = metrics;
+    wledAddress.fromString(host);
+    realtimeFrame[0] = 2;  // DRGB protocol
+    realtimeFrame[1] = NetworkConfig::WLED_REALTIME_TIMEOUT_S;
+
+    char taskName[configMAX_TASK_NAME_LEN];
+    snprintf(taskName, sizeof(taskName), "wled%u", index);
+    if (xTaskCreate(taskEntry, taskName, Tasks::WLED_STACK_SIZE, this,
+                    Tasks::WLED_PRIORITY, &taskHandle) != pdPASS) {
+        DEBUG_PRINTF("WLED network task creation failed for %s\n", host);
+        taskHandle = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void WLEDTarget::updateColor(int red, int green, int blue, uint32_t inputUs) {
+    portENTER_CRITICAL(&pendingLock);
+    pending.red = red;
+    pending.green = green;
+    pending.blue = blue;
+    markDirty(WLEDField::COLOR, inputUs);
+    portEXIT_CRITICAL(&pendingLock);
+
+    if (taskHandle) xTaskNotifyGive(taskHandle);
+}
+
+void WLEDTarget::updateEffect(int effectIndex, uint32_t inputUs) {
+    portENTER_CRITICAL(&pendingLock);
+    pending.effectIndex = effectIndex;
+    markDirty(WLEDField::EFFECT, inputUs);
+    portEXIT_CRITICAL(&pendingLock);
+
+    if (taskHandle) xTaskNotifyGive(taskHandle);
+}
+
+void WLEDTarget::updateBrightness(int brightness, uint32_t inputUs) {
+    portENTER_CRITICAL(&pendingLock);
+    pending.brightness = brightness;
+    markDirty(WLEDField::BRIGHTNESS, inputUs);
+    portEXIT_CRITICAL(&pendingLock);
+
+    if (taskHandle) xTaskNotifyGive(taskHandle);
+}
+
+void WLEDTarget::setTransport(WLEDTransport transport) {
+    portENTER_CRITICAL(&pendingLock);
+    pending.transport = transport;
+    portEXIT_CRITICAL(&pendingLock);
+
+    if (taskHandle) xTaskNotifyGive(taskHandle);
+}
+
+void WLEDTarget::adoptState(uint8_t fields, int red, int green, int blue, int effectIndex, int brightness) {
+    portENTER_CRITICAL(&pendingLock);
+    if (fields & WLEDField::COLOR) {
+        pending.red = red;
+        pending.green = green;
+        pending.blue = blue;
+    }
+    if (fields & WLEDField::EFFECT) pending.effectIndex = effectIndex;
+    if (fields & WLEDField::BRIGHTNESS) pending.brightness = brightness;
+    portEXIT_CRITICAL(&pendingLock);
+}
+
+void WLEDTarget::resendState() {
+    portENTER_CRITICAL(&pendingLock);
+    pending.dirty |= requestedFields;
+    portEXIT_CRITICAL(&pendingLock);
+    backoffReset = true;
+
+    if (taskHandle) xTaskNotifyGive(taskHandle);
+}
+
+bool WLEDTarget::isIdleFor(unsigned long ms) {
+    portENTER_CRITICAL(&pendingLock);
+    const bool dirty = pending.dirty != 0;
+    portEXIT_CRITICAL(&pendingLock);
+    return !dirty && !busy && !realtimeActive && !sweeping && millis() - idleSinceMs >= ms;
+}
+
+// Caller holds pendingLock
+void WLEDTarget::markDirty(uint8_t field, uint32_t inputUs) {
+    if (pending.dirty & field) stats.coalesced++;
+    pending.dirty |= field;
+    requestedFields |= field;
+    if (inputUs != 0 && pending.inputUs == 0) {
+        pending.inputUs = inputUs;
+        pending.queuedUs = micros();
+    }
+}
+
+WLEDConnectionStats WLEDTarget::getConnectionStats() {
+    portENTER_CRITICAL(&pendingLock);
+    WLEDConnectionStats copy = stats;
+    portEXIT_CRITICAL(&pendingLock);
+    return copy;
+}
+
+void WLEDTarget::taskEntry(void* param) {
+    static_cast<WLEDTarget*>(param)->runTask();
+}
+
+void WLEDTarget::runTask() {
+    PendingState state = pending;
+    for (;;) {
+        // While streaming, wake up after a quiet period to commit the color;
+        // while sweeping, once two send intervals pass without a new color
+        TickType_t wait = portMAX_DELAY;
+        if (realtimeActive) {
+            wait = pdMS_TO_TICKS(Timing::REALTIME_SETTLE_DELAY);
+        } else if (sweeping) {
+            const unsigned long quietMs = millis() - predictor.getLastMs();
+            const unsigned long limitMs = 2 * pacer.getIntervalMs();
+            wait = pdMS_TO_TICKS(quietMs < limitMs ? limitMs - quietMs : 1);
+        }
+        if (ulTaskNotifyTake(pdTRUE, wait) == 0) {
+            if (sweeping) {
+                settleSweep(state);
+                idleSinceMs = millis();
+                continue;
+            }
+            if (realtimeActive && WiFi.status() == WL_CONNECTED) {
+                // Realtime frames are transient; store the final color in WLED's own state
+                sendState(state, WLEDField::COLOR | WLEDField::BRIGHTNESS, true);
+            }
+            idleSinceMs = millis();
+            realtimeActive = false;
+            continue;
+        }
+
+        busy = true;
+
+        for (;;) {
+            if (backoffReset) {
+                backoffReset = false;
+                pacer.clearBackoff();
+                connectionOpen = false;     // The old socket died with the link
+            }
+            // Hold off until the pace allows another send; changes that
+            // arrive meanwhile merge into a single request
+            unsigned long waitMs = msUntilNextSend();
+            if (waitMs > 0) vTaskDelay(pdMS_TO_TICKS(waitMs));
+            if (!takePending(state)) break;
+
+            if (WiFi.status() != WL_CONNECTED) {
+                if (state.dirty) reportResult(state.dirty, HTTPC_ERROR_NOT_CONNECTED, 0);
+                activeTransport = state.transport;
+                realtimeActive = false;
+                continue;
+            }
+            activeTransport = state.transport;
+
+            uint8_t fields = state.dirty;
+            if (activeTransport == WLEDTransport::REALTIME_UDP && fields == WLEDField::COLOR) {
+                const uint32_t sendStartUs = micros();
+                const bool sent = sendRealtimeColor(state.red, state.green, state.blue);
+                recordLatency(state, sendStartUs, sent);
+                state.inputUs = 0;
+                continue;
+            }
+
+            // Effects, brightness and transport switches go over JSON, which
+            // also has to commit the streamed color and end realtime
+            bool leaveRealtime = realtimeActive;
+            if (leaveRealtime) fields |= WLEDField::COLOR;
+            if ((fields & WLEDField::COLOR) && !leaveRealtime) sendColorState(state, fields);
+            else if (fields) sendState(state, fields, leaveRealtime);
+            state.inputUs = 0;  // Timed; the settle commit must not count it again
+        }
+        idleSinceMs = millis();
+        busy = false;
+    }
+}
+
+bool WLEDTarget::takePending(PendingState& state) {
+    portENTER_CRITICAL(&pendingLock);
+    state = pending;
+    pending.dirty = 0;
+    pending.inputUs = 0;
+    portEXIT_CRITICAL(&pendingLock);
+    return state.dirty != 0 || state.transport != activeTransport;
+}
+
+unsigned long WLEDTarget::msUntilNextSend() const {
+    unsigned long now = millis();
+    if (activeTransport == WLEDTransport::REALTIME_UDP) {
+        unsigned long elapsed = now - lastFrameMs;
+        return elapsed >= Timing::REALTIME_FRAME_INTERVAL ? 0 : Timing::REALTIME_FRAME_INTERVAL - elapsed;
+    }
+    return pacer.msUntilReady(now);
+}
+
+void WLEDTarget::sendState(const PendingState& state, uint8_t fields, bool leaveRealtime,
+                           unsigned long transitionMs) {
+    payload.beginState();
+    // Colors have always been sent at the controller's brightness
+    if (fields & (WLEDField::COLOR | WLEDField::BRIGHTNESS)) payload.addBrightness(state.brightness);
+    if (leaveRealtime) payload.addLiveOff();
+    if (transitionMs > 0) payload.addTransition(transitionMs);
+    if (fields & WLEDField::COLOR) payload.addColor(state.red, state.green, state.blue);
+    if (fields & WLEDField::EFFECT) payload.addEffect(state.effectIndex);
+    payload.end();
+
+    sendRequest(fields, state);
+    realtimeActive = false;
+}
+
+// Once the predictor sees a steady sweep, each request carries where the
+// knob will be at the next send, with a "tt" of one send interval, so
+// WLED fades between requests instead of stepping. Requests keep the
+// pacer's spacing. A pace shorter than half a "tt" unit has nothing to
+// fade over, and a backed-off one is no sweep; both send exact colors.
+void WLEDTarget::sendColorState(const PendingState& state, uint8_t fields) {
+    const unsigned long intervalMs = pacer.getIntervalMs();
+    const bool canFade = intervalMs >= Timing::WLED_TRANSITION_UNIT / 2 &&
+                         intervalMs <= Timing::WLED_MAX_SEND_INTERVAL;
+    const bool predicting = predictor.observe(millis(), state.red, state.green, state.blue, intervalMs) && canFade;
+    if (!predicting) {
+        sendState(state, fields, false);
+        if (sweeping) endSweep(true);   // This exact color ends it
+        return;
+    }
+
+    PendingState target = state;
+    predictor.predict(intervalMs, target.red, target.green, target.blue);
+    settleOwed = target.red != state.red || target.green != state.green || target.blue != state.blue;
+
+    portENTER_CRITICAL(&pendingLock);
+    if (!sweeping) {
+        sweepStartMs = predictor.getStartMs();
+        stats.sweeps++;
+        stats.sweepRequests += Timing::WLED_SWEEP_SAMPLES;  // The exact colors that established it
+    }
+    stats.sweepRequests++;
+    portEXIT_CRITICAL(&pendingLock);
+    sweeping = true;
+
+    sendState(target, fields, false, intervalMs);
+}
+
+// No new color for two send intervals: the knob stopped. If the last
+// target was extrapolated, land on the knob's actual color. Realtime frames
+// already show it, and a dropped link resends it on reconnect.
+void WLEDTarget::settleSweep(const PendingState& state) {
+    const bool settle = settleOwed && !realtimeActive && WiFi.status() == WL_CONNECTED;
+    if (settle) sendState(state, WLEDField::COLOR, false, pacer.getIntervalMs());
+    endSweep(settle);
+}
+
+// landed: the request just sent carried the knob's exact color
+void WLEDTarget::endSweep(bool landed) {
+    const unsigned long lastSendMs = landed ? millis() : predictor.getLastMs();
+    portENTER_CRITICAL(&pendingLock);
+    if (landed) stats.sweepRequests++;
+    stats.sweepTimeMs += lastSendMs - sweepStartMs;
+    portEXIT_CRITICAL(&pendingLock);
+
+    predictor.end();
+    settleOwed = false;
+    sweeping = false;
+}
+
+bool WLEDTarget::sendRealtimeColor(int red, int green, int blue) {
+    for (size_t i = REALTIME_HEADER_SIZE; i < REALTIME_FRAME_SIZE; i += 3) {
+        realtimeFrame[i] = red;
+        realtimeFrame[i + 1] = green;
+        realtimeFrame[i + 2] = blue;
+    }
+
+    lastFrameMs = millis();
+    udp.beginPacket(wledAddress, NetworkConfig::WLED_REALTIME_PORT);
+    udp.write(realtimeFrame, REALTIME_FRAME_SIZE);
+    bool sent = udp.endPacket();
+    if (sent) {
+        portENTER_CRITICAL(&pendingLock);
+        stats.realtimeFrames++;
+        portEXIT_CRITICAL(&pendingLock);
+    }
+    realtimeActive = true;
+    return sent;
+}
+
+void WLEDTarget::openConnection() {
+    // Target and headers are set once; HTTPClient reconnects to the same
+    // host by itself whenever the socket has been closed in between
+    http.end();
+    http.begin(client, host, NetworkConfig::WLED_PORT, "/json/state");
+    http.setReuse(true);
+    http.setConnectTimeout(NetworkConfig::WLED_TIMEOUT_MS);  // A dead node must fail fast
+    http.setTimeout(NetworkConfig::WLED_TIMEOUT_MS);
+    http.addHeader("Content-Type", "application/json");
+    connectionOpen = true;
+}
+
+void WLEDTarget::sendRequest(uint8_t fields, const PendingState& state) {
+    if (payload.overflowed()) {
+        reportResult(fields, HTTPC_ERROR_TOO_LESS_RAM, 0);
+        return;
+    }
+    if (!connectionOpen) openConnection();
+
+    const uint32_t sendStartUs = micros();
+    unsigned long startTime = millis();
+    bool reused = http.connected();
+    int httpResponseCode = http.POST(payload.data(), payload.length());
+
+    // WLED may close an idle keep-alive socket; resend once on a fresh one
+    bool retried = false;
+    if (httpResponseCode < 0 && reused) {
+        openConnection();
+        reused = false;
+        retried = true;
+        httpResponseCode = http.POST(payload.data(), payload.length());
+    }
+
+    if (httpResponseCode > 0) {
+        if (!drainResponse()) {
+            // Unread body bytes would be taken for the next response
+            http.end();
+            connectionOpen = false;
+        }
+    } else {
+        connectionOpen = false;  // Start clean on the next request
+    }
+    unsigned long duration = millis() - startTime;
+    pacer.recordSend(startTime, duration, httpResponseCode > 0);
+
+    portENTER_CRITICAL(&pendingLock);
+    stats.requests++;
+    if (retried) stats.retries++;
+    if (reused) {
+        stats.reused++;
+        stats.reusedTimeMs += duration;
+    } else {
+        stats.reconnects++;
+        stats.freshTimeMs += duration;
+    }
+    stats.averageRoundTripMs = pacer.getAverageRoundTripMs();
+    stats.sendIntervalMs = pacer.getIntervalMs();
+    stats.consecutiveFailures = pacer.getConsecutiveFailures();
+    portEXIT_CRITICAL(&pendingLock);
+
+    uint32_t latencyUs = recordLatency(state, sendStartUs, httpResponseCode > 0);
+    reportResult(fields, httpResponseCode, duration, latencyUs);
+}
+
+// Splits the time since the input into its stages; returns the end-to-end
+// latency, or 0 when the request carried no timed input or failed
+uint32_t WLEDTarget::recordLatency(const PendingState& state, uint32_t sendStartUs, bool success) {
+    if (latency == nullptr || state.inputUs == 0 || !success) return 0;
+    const uint32_t nowUs = micros();
+    latency->queueToSend.record(sendStartUs - state.queuedUs);
+    latency->network.record(nowUs - sendStartUs);
+    latency->endToEnd.record(nowUs - state.inputUs);
+    return nowUs - state.inputUs;
+}
+
+// Returns false when the body was not read to its end, so the socket
+// cannot carry the next request
+bool WLEDTarget::drainResponse() {
+    // WLED only answers {"success":true} ("v":false), but the body must still
+    // be consumed before the socket can carry the next request
+    WiFiClient* stream = http.getStreamPtr();
+    if (stream == nullptr) return false;
+
+    // -1 for a chunked or close-delimited body: its end is unknown
+    int remaining = http.getSize();
+    if (remaining < 0) return false;
+
+    uint8_t scratch[64];
+    unsigned long start = millis();
+    while (remaining > 0 && stream->connected() &&
+           millis() - start < NetworkConfig::WLED_TIMEOUT_MS) {
+        size_t available = stream->available();
+        if (available == 0) {
+            delay(1);
+            continue;
+        }
+        size_t chunk = min(min(available, sizeof(scratch)), static_cast<size_t>(remaining));
+        int bytesRead = stream->read(scratch, chunk);
+        if (bytesRead <= 0) break;
+        remaining -= bytesRead;
+    }
+    return remaining == 0;
+}
+
+void WLEDTarget::reportResult(uint8_t fields, int httpCode, unsigned long roundTripMs, uint32_t latencyUs) {
+    WLEDResult result{targetIndex, fields, httpCode, roundTripMs, latencyUs};
+    // Drop the report rather than block the network task if loop() falls behind
+    xQueueSend(resultQueue, &result, 0);
+}
@@ -1,6 +1,9 @@
 #pragma once
 
+// Override with -D DEBUG=false to compile all debug output out
+#ifndef DEBUG
 #define DEBUG true
+#endif
 
 #if DEBUG
   #define DEBUG_PRINT(x) Serial.print(x)
@@ -23,6 +26,7 @@ namespace I2C {
     constexpr int SDA_PIN = 2;
     constexpr int SCL_PIN = 3;
     constexpr int FREQUENCY = 400000;  // 400kHz
+    constexpr size_t MAX_DATA_CHUNK = 127;  // ESP32 Wire buffer is 128 bytes, one goes to the control byte
 }
 
 // Pin Definitions
@@ -44,6 +48,47 @@ namespace Pins {
     constexpr int EFFECT_BUTTON = 8;
 }
 
+// Encoder channels (EncoderBank.h). Each row gets its own interrupt handler,
+// generated at compile time; adding a knob is a row here plus its handling
+// in processEncoders().
+namespace Encoders {
+    // Steps per detent by the time since the channel's previous detent:
+    // slowStep at slowMs or longer, rising along a square curve to fastStep
+    // at fastMs or shorter
+    struct Acceleration {
+        uint8_t slowStep;
+        uint8_t fastStep;
+        uint16_t slowMs;
+        uint16_t fastMs;
+    };
+
+    // Slow turns step by 1; a quick spin covers 0-255 in about 8 detents
+    constexpr Acceleration COLOR_ACCELERATION = {1, 32, 120, 15};
+    // One effect per detent at any speed
+    constexpr Acceleration NO_ACCELERATION = {1, 1, 0, 0};
+
+    struct Channel {
+        uint8_t pinA;
+        uint8_t pinB;
+        Acceleration acceleration;
+    };
+
+    enum Index : uint8_t {
+        RED = 0,
+        GREEN = 1,
+        BLUE = 2,
+        EFFECT = 3,
+        COUNT = 4
+    };
+
+    constexpr Channel CHANNELS[COUNT] = {
+        {Pins::RED_A, Pins::RED_B, COLOR_ACCELERATION},
+        {Pins::GREEN_A, Pins::GREEN_B, COLOR_ACCELERATION},
+        {Pins::BLUE_A, Pins::BLUE_B, COLOR_ACCELERATION},
+        {Pins::EFFECT_A, Pins::EFFECT_B, NO_ACCELERATION}
+    };
+}
+
 namespace Buttons {
     constexpr size_t NUM_BUTTONS = 4;  // Number of buttons
     enum class Index : uint8_t {
@@ -64,10 +109,44 @@ namespace Buttons {
     // Preset values for each button
     constexpr int PRESET_VALUE = 150;  // Move the preset value here
     
-    // Button timing configuration
-    constexpr unsigned long VERIFY_DELAY_US = 10;  // Microseconds delay for button verification
+    // Timer scan and integrating debounce (ButtonScanner.h)
+    constexpr uint32_t SCAN_INTERVAL_US = 1000;         // All buttons sampled at 1 kHz
+    constexpr uint8_t DEBOUNCE_TICKS = 8;               // Integrator depth: ~8 ms of steady level flips a button
+    constexpr unsigned long LONG_PRESS_MS = 600;        // Held this long: one LONG_PRESS event
+    constexpr unsigned long REPEAT_INTERVAL_MS = 150;   // Then a REPEAT event this often until released
+    // Rough cost of one CHANGE interrupt through the former per-edge handler
+    // (dispatcher, two pin reads, the clocks and its 10 us verify spin on
+    // presses), for the saved-time estimate in /api/metrics
+    constexpr uint32_t EDGE_ISR_ESTIMATE_US = 6;
+}
+
+// What the three color knobs control (ColorModel.h); a long press on the
+// effect button steps through them
+enum class ColorMode : uint8_t {
+    RGB,            // Red, green, blue, each gamma-corrected
+    HSV,            // Hue, saturation, value (gamma-corrected)
+    TEMPERATURE,    // White by color temperature, level; the blue knob is unused
+    COUNT
+};
+
+namespace ColorConfig {
+    constexpr ColorMode DEFAULT_MODE = ColorMode::RGB;
+    constexpr double GAMMA = 2.2;                   // Knob position to LED output
+    constexpr uint16_t TEMPERATURE_MIN_K = 1500;    // Temperature knob at 0
+    constexpr uint16_t TEMPERATURE_MAX_K = 9000;    // ... and at 255
+
+    // What the red, green and blue preset buttons pick in the other modes,
+    // at Buttons::PRESET_VALUE
+    constexpr uint8_t PRESET_HUES[] = {0, 85, 170};
+    constexpr uint16_t PRESET_TEMPERATURES_K[] = {2700, 4000, 6500};
 }
 
+// How color updates reach WLED
+enum class WLEDTransport : uint8_t {
+    JSON_API,       // HTTP POST to /json/state
+    REALTIME_UDP    // DRGB frames for color, JSON API for effects and leaving realtime
+};
+
 // Network Configuration
 namespace NetworkConfig {
     constexpr char WIFI_SSID[] = "your_ssid";
@@ -76,31 +155,123 @@ namespace NetworkConfig {
     constexpr char GATEWAY[] = "your_gateway";
     constexpr char SUBNET[] = "your_subnet";
     
-    // WLED Configuration
-    constexpr char WLED_IP[] = "your_wled_ip"; // IP of your WLED device
+    // WLED Configuration - every listed device follows the knobs
+    constexpr const char* WLED_IPS[] = {
+        "your_wled_ip"
+    };
+    constexpr size_t WLED_TARGET_COUNT = sizeof(WLED_IPS) / sizeof(WLED_IPS[0]);
     constexpr int WLED_PORT = 80;
+    constexpr uint16_t WLED_TIMEOUT_MS = 1000;  // HTTP timeout per WLED request
+
+    // WLED realtime (DRGB over UDP) settings
+    constexpr uint16_t WLED_REALTIME_PORT = 21324;
+    constexpr uint16_t WLED_LED_COUNT = 60;            // LEDs on the strip, max 490 for DRGB
+    constexpr uint8_t WLED_REALTIME_TIMEOUT_S = 2;     // WLED leaves realtime mode after this
+    constexpr WLEDTransport WLED_TRANSPORT = WLEDTransport::JSON_API;
+
+    // State sync over WLED's WebSocket (/ws): the knobs follow changes made
+    // in the WLED app. Index into WLED_IPS of the node to follow, -1 for none.
+    constexpr int WLED_SYNC_TARGET = 0;
+    constexpr uint32_t WLED_SYNC_RECONNECT_MS = 5000;
+    static_assert(WLED_SYNC_TARGET < static_cast<int>(WLED_TARGET_COUNT), "WLED_SYNC_TARGET must index WLED_IPS");
+
+    // Node whose effect and palette names the effect knob steps through
+    constexpr size_t WLED_CATALOG_TARGET = 0;
+    static_assert(WLED_CATALOG_TARGET < WLED_TARGET_COUNT, "WLED_CATALOG_TARGET must index WLED_IPS");
+
+    // Wi-Fi reconnects with exponential backoff between these bounds
+    constexpr unsigned long WIFI_CONNECT_TIMEOUT_MS = 10000;   // One association attempt
+    constexpr unsigned long WIFI_RETRY_MIN_MS = 500;
+    constexpr unsigned long WIFI_RETRY_MAX_MS = 60000;
+
+    // Server-Sent Events state stream at /api/events
+    constexpr size_t MAX_EVENT_CLIENTS = 4;
+    constexpr uint32_t EVENT_RETRY_MS = 2000;          // Client reconnect delay
+    constexpr uint32_t EVENT_FULL_RETRY_MS = 10000;    // Reconnect delay for clients turned away
 }
 
 // Display settings
 namespace DisplayConfig {
     constexpr int BAR_WIDTH = 20;
     constexpr int MARGIN = 10;
-    constexpr int MAX_HEIGHT = 48;
+    constexpr int MAX_HEIGHT = 38;
     constexpr int BASE_Y = 60;
+    constexpr int EFFECT_Y = 12;    // Effect name line, between the values and the bars
+    constexpr int MODE_TAG_WIDTH = 18;  // Color mode ("HSV") at the right end of that line
 }
 
-// Effect Names
+// Effect names by WLED effect ID. NAMES is WLED's own start of the list,
+// used until the node's full catalog (/json/eff) is fetched or loaded from flash.
 namespace Effects {
-    constexpr const char* NAMES[] = {  // Added const
-        "Solid", "Android", "Rainbow", "Chase", "Colorloop",
-        "Dancing", "Fire", "Glitter", "Ocean", "Plasma"
+    constexpr const char* NAMES[] = {
+        "Solid", "Blink", "Breathe", "Wipe", "Wipe Random",
+        "Random Colors", "Sweep", "Dynamic", "Colorloop", "Rainbow"
     };
-    constexpr int COUNT = 10;
+    constexpr int BUILTIN_COUNT = sizeof(NAMES) / sizeof(NAMES[0]);
+
+    constexpr size_t MAX_EFFECTS = 256;             // WLED 0.14 has about 190
+    constexpr size_t MAX_PALETTES = 128;            // and about 70 palettes
+    constexpr size_t NAME_POOL_SIZE = 4096;         // Distinct names, NUL-terminated
+    constexpr size_t MAX_NAME_LENGTH = 31;          // Longer names are cut
+    constexpr char CACHE_NAMESPACE[] = "wledfx";    // NVS namespace of the cached catalog
+    constexpr unsigned long RETRY_INTERVAL = 10000; // After a failed fetch
+}
+
+// FreeRTOS task settings
+namespace Tasks {
+    constexpr uint32_t WLED_STACK_SIZE = 6144;        // Per WLED target
+    constexpr UBaseType_t WLED_PRIORITY = 1;          // Same as loop(), so neither starves
+    constexpr UBaseType_t WLED_RESULT_QUEUE_LENGTH = 8;
+    constexpr uint32_t WLED_SYNC_STACK_SIZE = 8192;   // WebSocket client plus filtered JSON parse
+
+    // loop() never blocks, so anything below its priority would never run;
+    // the display shares loop()'s priority and gets round-robin slices
+    constexpr uint32_t DISPLAY_STACK_SIZE = 4096;
+    constexpr UBaseType_t DISPLAY_PRIORITY = 1;
+
+    // Formats deferred LOG() records; sleeps between drains, so it only
+    // takes time that loop() and the network tasks leave over
+    constexpr uint32_t LOG_STACK_SIZE = 3072;
+    constexpr UBaseType_t LOG_PRIORITY = 1;
+    constexpr size_t LOG_RING_SIZE = 64;            // Records, power of two
+
+    // Commits the state to NVS; only wakes every Storage::CHECK_INTERVAL
+    constexpr uint32_t STORE_STACK_SIZE = 3072;
+    constexpr UBaseType_t STORE_PRIORITY = 1;
+
+    // Fetches the effect catalog once per boot, then ends
+    constexpr uint32_t CATALOG_STACK_SIZE = 4096;
+    constexpr UBaseType_t CATALOG_PRIORITY = 1;
 }
 
 namespace Timing {
-    constexpr unsigned long DEBOUNCE_DELAY = 50;
     constexpr unsigned long DISPLAY_UPDATE_INTERVAL = 33;   // ~30fps
-    constexpr unsigned long WLED_UPDATE_INTERVAL = 150;     // Increased to reduce flicker
+    constexpr unsigned long WLED_UPDATE_INTERVAL = 150;     // Starting pace until WLED round trips are measured
+    constexpr unsigned long WLED_MIN_SEND_INTERVAL = 20;    // Fastest pace for a quick WLED node
+    constexpr unsigned long WLED_MAX_SEND_INTERVAL = 1000;  // Slowest pace for a struggling node
+    constexpr unsigned long WLED_BACKOFF_MAX = 30000;       // Retry ceiling for an unreachable node
+    constexpr unsigned long WLED_PACE_FACTOR = 2;           // Send interval as a multiple of the average round trip
+    constexpr uint8_t WLED_SWEEP_SAMPLES = 3;               // Consistent color rates in a row, one send apart, before predicting
+    constexpr float WLED_SWEEP_RATE_SPREAD = 2.0f;          // A rate further than this factor from the average restarts the count
+    constexpr unsigned long WLED_TRANSITION_UNIT = 100;     // ms per unit of WLED's "tt"
+    constexpr unsigned long REALTIME_FRAME_INTERVAL = 8;    // ~120fps UDP frames
+    constexpr unsigned long REALTIME_SETTLE_DELAY = 1000;   // Idle time before the color is committed via JSON
     constexpr unsigned long ENCODER_PROCESS_INTERVAL = 5;   // Process encoders more frequently
-}
\ No newline at end of file
+    constexpr unsigned long LOG_DRAIN_INTERVAL = 20;        // ms between log drains
+    constexpr unsigned long WLED_SYNC_POLL_INTERVAL = 10;   // ms between WebSocket polls
+    constexpr unsigned long WLED_SYNC_HOLDOFF = 500;        // Quiet time after our own sends before a push is trusted
+}
+// Persistent state in NVS
+namespace Storage {
+    constexpr char NAMESPACE[] = "rgbmixer";
+    constexpr uint32_t RECORD_SLOTS = 8;                // Record keys rotated through to spread wear
+    constexpr unsigned long SAVE_IDLE = 5000;           // Knobs idle this long before the state is saved
+    constexpr unsigned long MIN_SAVE_INTERVAL = 30000;  // At most one save per this, however often they stop
+    constexpr unsigned long CHECK_INTERVAL = 500;       // ms between checks of the published state
+}
+namespace Profiling {
+    constexpr unsigned long STAGE_BUDGET_US = 1000;     // A loop() stage slower than this counts as an overrun
+    constexpr unsigned long LOOP_BUDGET_US =            // Encoders must be serviced at least this often
+        Timing::ENCODER_PROCESS_INTERVAL * 1000;
+    constexpr unsigned long REPORT_INTERVAL = 1000;     // ms per published profiling window
+}
@@ -4,78 +4,31 @@
 #include "DisplayHandler.h"
 #include "WLEDController.h"
 #include "NetworkManager.h"
-#include "ButtonEventQueue.h"
+#include "InputEventQueue.h"
+#include "EncoderBank.h"
+#include "ButtonScanner.h"
 #include "StateManager.h"
+#include "StateStore.h"
+#include "LoopProfiler.h"
+#include "BinaryLog.h"
 
 
 // Global instances
-ButtonEventQueue buttonQueue;
-StateManager stateManager;
-DisplayHandler display;
+BinaryLog debugLog;
+InputEventQueue inputQueue;
+EncoderBank encoders;
+ButtonScanner buttonScanner;
 WLEDController wled;
+StateManager stateManager(wled.getCatalog());
+StateStore stateStore;
+DisplayHandler display;
 NetworkManager network;
+LoopProfiler profiler;
 
 // State tracking
-volatile bool encoderEvent = false;
-volatile int8_t encoderChanges[4] = {0};  // RED, GREEN, BLUE, EFFECT
-volatile uint8_t prevEncoderStates[4] = {0};  // RED, GREEN, BLUE, EFFECT
-volatile bool buttonStates[Buttons::NUM_BUTTONS] = {HIGH, HIGH, HIGH, HIGH};
-unsigned long lastButtonPress[Buttons::NUM_BUTTONS] = {0};
-
-// Encoder interrupt handler
-void IRAM_ATTR handleEncoder(uint8_t pinA, uint8_t pinB, volatile uint8_t& prevState, int encoderIndex) {
-    static const int8_t encoder_states[] = {0,-1,1,0,1,0,0,-1,-1,0,0,1,0,1,-1,0};
-    
-    prevState = (prevState << 2) & 0x0F;
-    prevState |= (digitalRead(pinA) << 1) | digitalRead(pinB);
-    
-    int8_t change = encoder_states[prevState];
-    if (change != 0) {
-        encoderChanges[encoderIndex] += change;
-        encoderEvent = true;
-    }
-}
-
-// Individual encoder interrupt handlers
-void IRAM_ATTR handleRedEncoder() { handleEncoder(Pins::RED_A, Pins::RED_B, prevEncoderStates[0], 0); }
-void IRAM_ATTR handleGreenEncoder() { handleEncoder(Pins::GREEN_A, Pins::GREEN_B, prevEncoderStates[1], 1); }
-void IRAM_ATTR handleBlueEncoder() { handleEncoder(Pins::BLUE_A, Pins::BLUE_B, prevEncoderStates[2], 2); }
-void IRAM_ATTR handleEffectEncoder() { handleEncoder(Pins::EFFECT_A, Pins::EFFECT_B, prevEncoderStates[3], 3); }
-
-// Generic button handler
-void IRAM_ATTR handleButton(uint8_t pin, Buttons::Index buttonIndex, Buttons::ID buttonId) {
-    bool currentState = digitalRead(pin);
-    unsigned long currentTime = millis();
-    
-    if (currentTime - lastButtonPress[static_cast<uint8_t>(buttonIndex)] > Timing::DEBOUNCE_DELAY) {
-        if (currentState == LOW && buttonStates[static_cast<uint8_t>(buttonIndex)] == HIGH) {
-            delayMicroseconds(Buttons::VERIFY_DELAY_US);  // Using constant from config
-            if (digitalRead(pin) == LOW) {
-                buttonQueue.push(buttonId, true, currentTime);
-                lastButtonPress[static_cast<uint8_t>(buttonIndex)] = currentTime;
-            }
-        }
-        buttonStates[static_cast<uint8_t>(buttonIndex)] = currentState;
-    }
-}
-
-// Individual button interrupt handlers
-void IRAM_ATTR handleRedButton() { handleButton(Pins::RED_BUTTON, Buttons::Index::RED_INDEX, Buttons::ID::RED_ID);}
-void IRAM_ATTR handleGreenButton() { handleButton(Pins::GREEN_BUTTON, Buttons::Index::GREEN_INDEX, Buttons::ID::GREEN_ID);}
-void IRAM_ATTR handleBlueButton() { handleButton(Pins::BLUE_BUTTON, Buttons::Index::BLUE_INDEX, Buttons::ID::BLUE_ID);}
-void IRAM_ATTR handleEffectButton() { handleButton(Pins::EFFECT_BUTTON, Buttons::Index::EFFECT_INDEX, Buttons::ID::EFFECT_ID);}
+uint32_t remoteStatesApplied = 0;
 
 void setupPins() {
-    // Configure encoder pins
-    const uint8_t encoderPins[] = {
-        Pins::RED_A, Pins::RED_B, Pins::GREEN_A, Pins::GREEN_B,
-        Pins::BLUE_A, Pins::BLUE_B, Pins::EFFECT_A, Pins::EFFECT_B
-    };
-    
-    for (uint8_t pin : encoderPins) {
-        pinMode(pin, INPUT_PULLUP);
-    }
-
     // Configure button pins
     const uint8_t buttonPins[] = {
         Pins::RED_BUTTON, Pins::GREEN_BUTTON, 
@@ -86,31 +39,30 @@ void setupPins() {
         pinMode(pin, INPUT_PULLUP);
     }
 
-    // Attach encoder interrupts
-    attachInterrupt(digitalPinToInterrupt(Pins::RED_A), handleRedEncoder, CHANGE);
-    attachInterrupt(digitalPinToInterrupt(Pins::RED_B), handleRedEncoder, CHANGE);
-    attachInterrupt(digitalPinToInterrupt(Pins::GREEN_A), handleGreenEncoder, CHANGE);
-    attachInterrupt(digitalPinToInterrupt(Pins::GREEN_B), handleGreenEncoder, CHANGE);
-    attachInterrupt(digitalPinToInterrupt(Pins::BLUE_A), handleBlueEncoder, CHANGE);
-    attachInterrupt(digitalPinToInterrupt(Pins::BLUE_B), handleBlueEncoder, CHANGE);
-    attachInterrupt(digitalPinToInterrupt(Pins::EFFECT_A), handleEffectEncoder, CHANGE);
-    attachInterrupt(digitalPinToInterrupt(Pins::EFFECT_B), handleEffectEncoder, CHANGE);
-
-    // Attach button interrupts
-    attachInterrupt(digitalPinToInterrupt(Pins::RED_BUTTON), handleRedButton, CHANGE);
-    attachInterrupt(digitalPinToInterrupt(Pins::GREEN_BUTTON), handleGreenButton, CHANGE);
-    attachInterrupt(digitalPinToInterrupt(Pins::BLUE_BUTTON), handleBlueButton, CHANGE);
-    attachInterrupt(digitalPinToInterrupt(Pins::EFFECT_BUTTON), handleEffectButton, CHANGE);
+    // One handler per encoder channel, each reading its pins in one register load
+    encoders.begin();
+
+    // Buttons are sampled by a timer rather than interrupting on every bounce
+    if (!buttonScanner.begin(inputQueue)) {
+        DEBUG_PRINTLN("Buttons disabled!");
+    }
 }
 
 void setup() {
     Serial.begin(115200);
-    delay(1000);
     
     DEBUG_PRINTLN("\n\nStarting RGB Controller...");
     DEBUG_PRINTLN("Version: " __DATE__ " " __TIME__);
+    debugLog.begin();
+
+    // Before anything renders or sends: the first frame and the first WLED
+    // request already carry the saved state. The cached effect catalog
+    // comes first, so a saved effect beyond the built-in names survives.
+    wled.getCatalog().restore();
+    StateSnapshot saved;
+    if (stateStore.restore(saved)) stateManager.restoreState(saved);
 
-    if (!display.begin()) {
+    if (!display.begin(wled.getCatalog())) {
         DEBUG_PRINTLN("Display initialization failed!");
         while (1) delay(100);
     }
@@ -119,56 +71,83 @@ void setup() {
     setupPins();
     DEBUG_PRINTLN("Pins configured successfully");
 
+    // Returns at once; the link comes up (and is kept up) via network.service()
     if (!network.begin()) {
         DEBUG_PRINTLN("Network initialization failed! Continuing with local display only.");
     }
    
-    network.setupWebServer(stateManager);
-    DEBUG_PRINTLN("Initialization complete!");
-    DEBUG_PRINTF("Current WLED IP: %s\n", NetworkConfig::WLED_IP);
+    network.setupWebServer(stateManager, wled.getLatencyMetrics(), profiler, stateStore, wled.getCatalog(),
+                           buttonScanner, wled);
+
+    if (!wled.begin()) {
+        DEBUG_PRINTLN("WLED network task failed to start! WLED updates disabled.");
+    }
+    wled.setTransport(NetworkConfig::WLED_TRANSPORT);
+    profiler.begin();
+    if (!stateStore.begin(stateManager)) {
+        DEBUG_PRINTLN("State store failed to start! Changes will not persist.");
+    }
+    DEBUG_PRINTF("Initialization complete in %lu ms\n", millis());
+    for (size_t i = 0; i < wled.getTargetCount(); i++) {
+        DEBUG_PRINTF("WLED target %u: %s\n", static_cast<unsigned>(i), wled.getTargetAddress(i));
+    }
 }
 
 void processEncoders() {
-    if (!encoderEvent) return;
-    
-    noInterrupts();
-    bool colorChanged = false;
-    
-    // Process RGB encoders
-    if (encoderChanges[0] != 0 || encoderChanges[1] != 0 || encoderChanges[2] != 0) {
-        stateManager.adjustColor(
-            encoderChanges[0] * 5,
-            encoderChanges[1] * 5,
-            encoderChanges[2] * 5
-        );
-        encoderChanges[0] = encoderChanges[1] = encoderChanges[2] = 0;
-        colorChanged = true;
+    int16_t steps[Encoders::COUNT];
+    uint32_t inputUs;
+    if (!encoders.take(steps, inputUs)) return;
+    if (inputUs != 0) stateManager.noteInput(inputUs);
+
+    const int red = steps[Encoders::RED];
+    const int green = steps[Encoders::GREEN];
+    const int blue = steps[Encoders::BLUE];
+    const int effect = steps[Encoders::EFFECT];
+
+    // Process RGB encoders; steps arrive already accelerated
+    if (red != 0 || green != 0 || blue != 0) {
+        stateManager.adjustColor(red, green, blue);
+
+        const auto& color = stateManager.getColorState();
+        LOG(COLOR_UPDATE,
+            color.red, color.green, color.blue);
     }
     
     // Process effect encoder
-    if (encoderChanges[3] != 0) {
-        stateManager.adjustEffect(encoderChanges[3]);
-        encoderChanges[3] = 0;
-    }
-    
-    encoderEvent = false;
-    interrupts();
-    
-    if (colorChanged) {
-        const auto& color = stateManager.getColorState();
-        DEBUG_PRINTF("Color Update - R:%d G:%d B:%d\n", 
-            color.red, color.green, color.blue);
+    if (effect != 0) {
+        stateManager.adjustEffect(effect);
     }
 }
 
+// The color buttons act as soon as they are pressed. The effect button
+// waits for release: a short press resets the effect, holding it steps the
+// color mode instead.
 void processButtons() {
-    ButtonEvent event;
-    while (buttonQueue.pop(&event)) {
-        if (!event.pressed) continue;
+    static bool effectHeld = false;
+    InputEvent event;
+    while (inputQueue.pop(event)) {
+        if (event.type != InputEventType::BUTTON) continue;
+        const bool effectButton = event.buttonId() == Buttons::ID::EFFECT_ID;
+        if (event.action() == ButtonAction::LONG_PRESS || event.action() == ButtonAction::REPEAT) {
+            LOG(BUTTON_HOLD, event.source, event.action() == ButtonAction::REPEAT ? "repeat" : "long press");
+            if (effectButton && event.action() == ButtonAction::LONG_PRESS) {
+                effectHeld = true;
+                LOG(COLOR_MODE, ColorModel::modeName(stateManager.cycleColorMode()));
+            }
+            continue;
+        }
+        if (effectButton) {
+            const bool shortPress = event.action() == ButtonAction::RELEASED && !effectHeld;
+            if (event.action() == ButtonAction::RELEASED) effectHeld = false;
+            if (!shortPress) continue;
+        } else if (!event.pressed()) {
+            continue;
+        }
         
-        DEBUG_PRINTF("Processing button %d press\n", event.button);
+        LOG(BUTTON_PRESS, event.source);
+        stateManager.noteInput(event.timestampUs);
         
-        switch (event.button) {
+        switch (event.buttonId()) {
             case Buttons::ID::RED_ID:
                 stateManager.setRedPreset();
                 break;
@@ -185,26 +164,130 @@ void processButtons() {
     }
 }
 
+// Keeps Wi-Fi up; WLED missed whatever changed while the link was down
+void processNetwork() {
+    if (network.service()) wled.resendState();
+}
+
+void processWLEDResults() {
+    WLEDResult result;
+    while (wled.pollResult(result)) {
+        const char* color = (result.fields & WLEDField::COLOR) ? " color" : "";
+        const char* effect = (result.fields & WLEDField::EFFECT) ? " effect" : "";
+        const char* brightness = (result.fields & WLEDField::BRIGHTNESS) ? " brightness" : "";
+        const char* address = wled.getTargetAddress(result.target);
+        if (result.httpCode > 0) {
+            LOG(WLED_OK,
+                address, color, effect, brightness, result.httpCode, result.roundTripMs,
+                result.latencyUs);
+        } else {
+            LOG(WLED_FAILED, address, color, effect, brightness, result.httpCode, result.roundTripMs);
+        }
+    }
+}
+
+// Follow changes made on the WLED side (its app, presets, other
+// controllers). Only what differs is applied, and the change flags stay
+// clear, so it is never sent back to the node that reported it.
+void processRemoteState() {
+    WLEDRemoteState remote;
+    if (!wled.pollRemoteState(remote)) return;
+
+    uint8_t changed = 0;
+    if ((remote.fields & WLEDField::COLOR) &&
+        stateManager.syncColor(remote.red, remote.green, remote.blue)) {
+        changed |= WLEDField::COLOR;
+    }
+    if ((remote.fields & WLEDField::EFFECT) && stateManager.syncEffect(remote.effectIndex)) {
+        changed |= WLEDField::EFFECT;
+    }
+    if ((remote.fields & WLEDField::BRIGHTNESS) && stateManager.syncBrightness(remote.brightness)) {
+        changed |= WLEDField::BRIGHTNESS;
+    }
+    if (changed == 0) return;  // Usually WLED confirming our own last request
+
+    const auto& color = stateManager.getColorState();
+    LOG(WLED_SYNC_APPLY,
+        color.red, color.green, color.blue, stateManager.getEffectIndex(), stateManager.getBrightness());
+    wled.forwardRemoteState(remote, changed);
+    remoteStatesApplied++;
+}
+
 void printDebugInfo() {
     static unsigned long lastDebugPrint = 0;
     unsigned long currentMillis = millis();
     
     if (currentMillis - lastDebugPrint >= 5000) {
-        const auto& debugInfo = buttonQueue.getDebugInfo();
+        const auto debugInfo = inputQueue.getDebugInfo();
         const auto& color = stateManager.getColorState();
         
-        DEBUG_PRINTLN("\n----- DEBUG INFO -----");
-        DEBUG_PRINTF("Queue - Push attempts: %lu, Success: %lu\n", 
-                     debugInfo.pushAttempts, debugInfo.pushSuccess);
-        DEBUG_PRINTF("Queue - Pop attempts: %lu, Success: %lu\n", 
-                     debugInfo.popAttempts, debugInfo.popSuccess);
-        DEBUG_PRINTF("Last button - Pushed: %lu, Processed: %lu\n", 
-                     debugInfo.lastPushedButton, debugInfo.lastProcessedButton);
-        DEBUG_PRINTF("Interrupts: %lu, Debounce checks: %lu\n", 
-                     debugInfo.interruptCalls, debugInfo.debounceChecks);
-        DEBUG_PRINTF("Current Values - R:%d G:%d B:%d Effect:%d\n", 
-                     color.red, color.green, color.blue, stateManager.getEffectIndex());
-        DEBUG_PRINTLN("--------------------\n");
+        LOG(DEBUG_HEADER);
+        LOG(DEBUG_QUEUE_PUSH,
+            debugInfo.pushAttempts, debugInfo.pushSuccess);
+        LOG(DEBUG_QUEUE_POP,
+            debugInfo.popAttempts, debugInfo.popSuccess, debugInfo.overflows);
+        LOG(DEBUG_SOURCES,
+            debugInfo.lastPushedSource, debugInfo.lastProcessedSource);
+        LOG(DEBUG_INTERRUPTS,
+            debugInfo.interruptCalls, debugInfo.debounceChecks);
+        const auto scanStats = buttonScanner.getStats();
+        LOG(DEBUG_BUTTONS,
+            scanStats.averageScanNs, scanStats.maxScanUs, scanStats.scanTimeUs,
+            scanStats.edges, scanStats.edgeIsrEstimateUs);
+        LOG(DEBUG_VALUES,
+            color.red, color.green, color.blue, stateManager.getEffectIndex(),
+            ColorModel::modeName(stateManager.getColorMode()));
+
+        LOG(DEBUG_DISPLAY,
+            display.getFramesPublished(), display.getFramesDropped(), display.getTotalBytes());
+
+        for (size_t i = 0; i < wled.getTargetCount(); i++) {
+            const auto wledStats = wled.getConnectionStats(i);
+            LOG(DEBUG_WLED, wled.getTargetAddress(i),
+                wledStats.consecutiveFailures == 0 ? "healthy" : "backing off",
+                wledStats.consecutiveFailures);
+            LOG(DEBUG_WLED_CONN,
+                wledStats.requests, wledStats.reused, wledStats.reconnects, wledStats.retries);
+            LOG(DEBUG_WLED_TIME,
+                wledStats.reused ? wledStats.reusedTimeMs / wledStats.reused : 0UL,
+                wledStats.reconnects ? wledStats.freshTimeMs / wledStats.reconnects : 0UL,
+                wledStats.realtimeFrames);
+            LOG(DEBUG_WLED_PACE,
+                wledStats.coalesced, wledStats.averageRoundTripMs, wledStats.sendIntervalMs);
+            LOG(DEBUG_WLED_SWEEP,
+                wledStats.sweeps, wledStats.sweepRequests,
+                wledStats.sweeps ? wledStats.sweepRequests * 10 / wledStats.sweeps / 10 : 0UL,
+                wledStats.sweeps ? wledStats.sweepRequests * 10 / wledStats.sweeps % 10 : 0UL,
+                wledStats.sweepTimeMs);
+        }
+        LOG(DEBUG_WLED_SYNC,
+            wled.isSyncConnected() ? "connected" : "not connected",
+            wled.getSyncPushCount(), remoteStatesApplied);
+        LOG(DEBUG_WIFI,
+            network.isConnected() ? "connected" : "not connected",
+            network.getReconnects(), network.getRetryDelayMs());
+        const EffectCatalog& catalog = wled.getCatalog();
+        LOG(DEBUG_CATALOG,
+            catalog.getSourceName(), catalog.getVersion(),
+            catalog.getEffectCount(), catalog.getPaletteCount());
+        LOG(DEBUG_STORE,
+            stateStore.getWrites(), stateStore.getWritesLastHour(), stateStore.getFailedWrites(),
+            stateStore.getSequence());
+        const auto endToEnd = wled.getLatencyMetrics().endToEnd.summarize();
+        LOG(DEBUG_LATENCY,
+            endToEnd.count, endToEnd.p50Us, endToEnd.p95Us, endToEnd.p99Us, endToEnd.maxUs);
+
+        // Last full profiling window; a stage with overruns is what delays the encoders
+        const auto profile = profiler.getReport();
+        LOG(DEBUG_LOOP,
+            profile.loopHz, profile.loop.averageUs, profile.loop.maxUs,
+            Profiling::LOOP_BUDGET_US, profile.loop.overruns);
+        for (size_t i = 0; i < LoopProfiler::STAGE_COUNT; i++) {
+            const auto& stage = profile.stages[i];
+            LOG(DEBUG_LOOP_STAGE,
+                LoopProfiler::stageName(i), stage.minUs, stage.averageUs, stage.maxUs, stage.overruns);
+        }
+        LOG(DEBUG_FOOTER);
         
         lastDebugPrint = currentMillis;
     }
@@ -212,34 +295,50 @@ void printDebugInfo() {
 
 void loop() {
     static unsigned long lastDisplayUpdate = 0;
-    static unsigned long lastWLEDUpdate = 0;
     unsigned long currentMillis = millis();
+    profiler.startLoop();
     
     processEncoders();
+    profiler.endStage(LoopStage::ENCODERS);
     processButtons();
+    profiler.endStage(LoopStage::BUTTONS);
+    processNetwork();
+    profiler.endStage(LoopStage::NETWORK);
+    processWLEDResults();
+    profiler.endStage(LoopStage::WLED_RESULTS);
+    processRemoteState();
+    profiler.endStage(LoopStage::REMOTE_STATE);
     printDebugInfo();
+    profiler.endStage(LoopStage::DEBUG_INFO);
     
     // Update display
     if (currentMillis - lastDisplayUpdate >= Timing::DISPLAY_UPDATE_INTERVAL) {
-        const auto& color = stateManager.getColorState();
-        display.updateDisplay(color.red, color.green, color.blue);
+        const auto snapshot = stateManager.getSnapshot();
+        display.updateDisplay(snapshot.colorMode, snapshot.knobs, snapshot.effectIndex);
+        network.streamState();
         lastDisplayUpdate = currentMillis;
     }
+    profiler.endStage(LoopStage::DISPLAY);
     
-    // Update WLED
-    if (currentMillis - lastWLEDUpdate >= Timing::WLED_UPDATE_INTERVAL) {
+    // Hand changes to the WLED scheduler; it merges and paces them itself
+    const uint32_t inputUs = stateManager.takeInputTimestamp();
+    if (stateManager.hasColorChanged()) {
         const auto& color = stateManager.getColorState();
-        if (stateManager.hasColorChanged()) {  // Simplified check
-            DEBUG_PRINTF("Sending WLED update - R:%d G:%d B:%d\n", 
-                color.red, color.green, color.blue);
-            wled.updateColor(color.red, color.green, color.blue);
-            stateManager.clearColorChanged();
-        } else if (stateManager.hasEffectChanged()) {
-            DEBUG_PRINTF("Sending WLED effect update: %s\n", 
-                Effects::NAMES[stateManager.getEffectIndex()]);
-            wled.updateEffect(stateManager.getEffectIndex());
-            stateManager.clearEffectChanged();
-        }
-        lastWLEDUpdate = currentMillis;
+        LOG(WLED_SEND_COLOR,
+            color.red, color.green, color.blue);
+        wled.updateColor(color.red, color.green, color.blue, inputUs);
+        stateManager.clearColorChanged();
+    }
+    if (stateManager.hasEffectChanged()) {
+        LOG(WLED_SEND_EFFECT,
+            wled.getCatalog().getEffectName(stateManager.getEffectIndex()));
+        wled.updateEffect(stateManager.getEffectIndex(), inputUs);
+        stateManager.clearEffectChanged();
+    }
+    if (stateManager.hasBrightnessChanged()) {
+        wled.updateBrightness(stateManager.getBrightness(), inputUs);
+        stateManager.clearBrightnessChanged();
     }
+    profiler.endStage(LoopStage::WLED_SEND);
+    profiler.endLoop();
 }
\ No newline at end of file